@@ -31,6 +31,7 @@ src/bsp/driver/ae350 \
 src/bsp/lib \
 src/demo/cache \
 src/demo/cache_lock \
+src/demo/dma \
 src/demo/gpio \
 src/demo/hsp \
 src/demo/i2c \
@@ -39,6 +40,7 @@ src/demo/intr \
 src/demo/led \
 src/demo \
 src/demo/mm \
+src/demo/mm_bench \
 src/demo/pfm \
 src/demo/plic \
 src/demo/plmt \
@@ -4,22 +4,31 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../src/bsp/lib/arena.c \
 ../src/bsp/lib/delay.c \
+../src/bsp/lib/log.c \
 ../src/bsp/lib/mm.c \
+../src/bsp/lib/pool.c \
 ../src/bsp/lib/printf.c \
 ../src/bsp/lib/read.c \
 ../src/bsp/lib/uart.c 
 
 OBJS += \
+./src/bsp/lib/arena.o \
 ./src/bsp/lib/delay.o \
+./src/bsp/lib/log.o \
 ./src/bsp/lib/mm.o \
+./src/bsp/lib/pool.o \
 ./src/bsp/lib/printf.o \
 ./src/bsp/lib/read.o \
 ./src/bsp/lib/uart.o 
 
 C_DEPS += \
+./src/bsp/lib/arena.d \
 ./src/bsp/lib/delay.d \
+./src/bsp/lib/log.d \
 ./src/bsp/lib/mm.d \
+./src/bsp/lib/pool.d \
 ./src/bsp/lib/printf.d \
 ./src/bsp/lib/read.d \
 ./src/bsp/lib/uart.d 
@@ -10,6 +10,10 @@
 // Includes ---------------------------------------------------------------------------------
 #include "platform.h"
 
+#ifdef CFG_CACHE_ENABLE
+#include "cache.h"
+#endif
+
 
 // Declarations -----------------------------------------------------------------------------
 extern void reset_vector(void);
@@ -93,4 +97,9 @@ void system_init(void)
 
 	/* Enable misaligned access and non-blocking load */
 	set_csr(NDS_MMISC_CTL, (1 << 8) | (1 << 6));
+
+#ifdef CFG_CACHE_ENABLE
+	/* Range size from which the D-Cache maintenance uses whole D-Cache operations */
+	ae350_dcache_calibrate();
+#endif
 }
@@ -8,7 +8,9 @@
  */
 
 // Includes ----------------------------------------------------------------------------------
+#include "platform.h"
 #include "cache.h"
+#include "mm.h"
 
 
 // Definitions -------------------------------------------------------------------------------
@@ -23,6 +25,13 @@
 #define AE350_DWAY					0x38
 #define AE350_DSIZE					0x1C0
 
+/* MMSC_CFG */
+#define AE350_VCCTL					0xC0000		// CCTL begin address auto-increment
+#define AE350_CCTLCSR				0x10000		// CCTL CSRs
+
+/* Lines timed by ae350_dcache_calibrate() */
+#define CALIBRATE_LINES				64
+
 /* L1 CCTL Command */
 #define CCTL_L1D_VA_INVAL			0
 #define CCTL_L1D_VA_WB				1
@@ -76,6 +85,8 @@ static ALWAYS_INLINE void GIE_RESTORE(unsigned long var)
 
 /* Cache APIs */
 struct _cache_info cache_info = {.is_init = 0};
+struct _dma_line_safe dma_line_safe = {0, 0};
+static struct _cctl_stats cctl_stats;
 enum cache_t {ICACHE, DCACHE};
 
 // Get cache information
@@ -99,6 +110,21 @@ void get_cache_info(void)
 			cache_info.cacheline_size = 0;
 		}
 
+		/* Get cache sets and ways once, the configuration CSRs do not change */
+		unsigned long icm_cfg = read_csr(NDS_MICM_CFG);
+		unsigned long dcm_cfg = read_csr(NDS_MDCM_CFG);
+
+		cache_info.iset = ((icm_cfg & AE350_ISET) < 7) ? (1UL << ((icm_cfg & AE350_ISET) + 6)) : 0;
+		cache_info.iway = ((icm_cfg & AE350_IWAY) >> 3) + 1;
+		cache_info.dset = ((dcm_cfg & AE350_DSET) < 7) ? (1UL << ((dcm_cfg & AE350_DSET) + 6)) : 0;
+		cache_info.dway = ((dcm_cfg & AE350_DWAY) >> 3) + 1;
+
+		/* One CCTL command CSR write per line when the begin address auto-increments */
+		cache_info.vcctl = (read_csr(NDS_MMSC_CFG) & AE350_VCCTL) ? 1 : 0;
+
+		/* A range of the D-Cache size or more touches every line anyway, until calibrated */
+		cache_info.whole_size = cache_info.dset * cache_info.dway * cache_info.cacheline_size;
+
 		/* Finish initialization */
 		cache_info.is_init = 1;
 	}
@@ -109,31 +135,23 @@ void get_cache_info(void)
 // Cache settings
 static inline unsigned long cache_set(enum cache_t cache)
 {
-	if (cache == ICACHE)
-	{
-		// I-Cache
-		return ((read_csr(NDS_MICM_CFG) & AE350_ISET) < 7) ? (unsigned long)(1 << ((read_csr(NDS_MICM_CFG) & AE350_ISET) + 6)) : 0;
-	}
-	else
+	if (!cache_info.is_init)
 	{
-		// D-Cache
-		return ((read_csr(NDS_MDCM_CFG) & AE350_DSET) < 7) ? (unsigned long)(1 << ((read_csr(NDS_MDCM_CFG) & AE350_DSET) + 6)) : 0;
+		get_cache_info();
 	}
+
+	return (cache == ICACHE) ? cache_info.iset : cache_info.dset;
 }
 
 // Cache ways
 static inline unsigned long cache_way(enum cache_t cache)
 {
-	if (cache == ICACHE)
-	{
-		// I-Cache
-		return (unsigned long)(((read_csr(NDS_MICM_CFG) & AE350_IWAY) >> 3) + 1);
-	}
-	else
+	if (!cache_info.is_init)
 	{
-		// D-Cache
-		return (unsigned long)(((read_csr(NDS_MDCM_CFG) & AE350_DWAY) >> 3) + 1);
+		get_cache_info();
 	}
+
+	return (cache == ICACHE) ? cache_info.iway : cache_info.dway;
 }
 
 /* Low-level Cache APIs */
@@ -143,21 +161,47 @@ static inline unsigned long cache_way(enum cache_t cache)
  * 1 CCTL register because IRQ can pollute CCTL register. Thus, caller needs to
  * protect thread-safety of them.
  */
-static void ae350_l1c_icache_invalidate_range(unsigned long start, unsigned long size)
+// VA-based CCTL command on every line of a range
+static void ae350_l1c_va_range(unsigned long start, unsigned long size, unsigned long command)
 {
 	unsigned long line_size = cache_line_size();
 
+	if (!size || !line_size)
+	{
+		return;
+	}
+
 	unsigned long last_byte = start + size - 1;
 	start = ROUND_DOWN(start, line_size);
 
-	while (start <= last_byte)
+	if (cache_info.vcctl)
 	{
+		/* The command CSR write moves the begin address to the next line */
+		unsigned long lines = ((last_byte - start) >> __builtin_ctzl(line_size)) + 1;
+
 		write_csr(NDS_MCCTLBEGINADDR, start);
-		write_csr(NDS_MCCTLCOMMAND, CCTL_L1I_VA_INVAL);
-		start += line_size;
+
+		while (lines--)
+		{
+			write_csr(NDS_MCCTLCOMMAND, command);
+		}
+	}
+	else
+	{
+		while (start <= last_byte)
+		{
+			write_csr(NDS_MCCTLBEGINADDR, start);
+			write_csr(NDS_MCCTLCOMMAND, command);
+			start += line_size;
+		}
 	}
 }
 
+static void ae350_l1c_icache_invalidate_range(unsigned long start, unsigned long size)
+{
+	ae350_l1c_va_range(start, size, CCTL_L1I_VA_INVAL);
+}
+
 /*
  * ae350_l1c_icache_invalidate_all(void)
  *
@@ -182,49 +226,19 @@ static void ae350_l1c_icache_invalidate_all(void)
 // L1 D-Cache write back range
 static void ae350_l1c_dcache_writeback_range(unsigned long start, unsigned long size)
 {
-	unsigned long line_size = cache_line_size();
-
-	unsigned long last_byte = start + size - 1;
-	start = ROUND_DOWN(start, line_size);
-
-	while (start <= last_byte)
-	{
-		write_csr(NDS_MCCTLBEGINADDR, start);
-		write_csr(NDS_MCCTLCOMMAND, CCTL_L1D_VA_WB);
-		start += line_size;
-	}
+	ae350_l1c_va_range(start, size, CCTL_L1D_VA_WB);
 }
 
 // L1 D-Cache invalidate range
 static void ae350_l1c_dcache_invalidate_range(unsigned long start, unsigned long size)
 {
-	unsigned long line_size = cache_line_size();
-
-	unsigned long last_byte = start + size - 1;
-	start = ROUND_DOWN(start, line_size);
-
-	while (start <= last_byte)
-	{
-		write_csr(NDS_MCCTLBEGINADDR, start);
-		write_csr(NDS_MCCTLCOMMAND, CCTL_L1D_VA_INVAL);
-		start += line_size;
-	}
+	ae350_l1c_va_range(start, size, CCTL_L1D_VA_INVAL);
 }
 
 // L1 D-Cache flush range
 static void ae350_l1c_dcache_flush_range(unsigned long start, unsigned long size)
 {
-	unsigned long line_size = cache_line_size();
-
-	unsigned long last_byte = start + size - 1;
-	start = ROUND_DOWN(start, line_size);
-
-	while (start <= last_byte)
-	{
-		write_csr(NDS_MCCTLBEGINADDR, start);
-		write_csr(NDS_MCCTLCOMMAND, CCTL_L1D_VA_WBINVAL);
-		start += line_size;
-	}
+	ae350_l1c_va_range(start, size, CCTL_L1D_VA_WBINVAL);
 }
 
 // L1 D-Cache flush all
@@ -279,6 +293,98 @@ void ae350_dcache_flush_range(unsigned long start, unsigned long size)
 	GIE_RESTORE(saved_gie);
 }
 
+// Dirty the lines of a range, one store per line
+static void ae350_dcache_dirty(unsigned long start, unsigned long size, unsigned long line_size)
+{
+	volatile unsigned long *p;
+
+	for (p = (volatile unsigned long *)start; (unsigned long)p < start + size; p += line_size / sizeof(*p))
+	{
+		*p = (unsigned long)p;
+	}
+}
+
+/*
+ * ae350_dcache_calibrate(void)
+ *
+ * Time the write back of CALIBRATE_LINES dirty lines against a whole D-Cache write
+ * back of a D-Cache full of dirty lines, the worst case of the whole operation, and
+ * set the DMA range size from which the whole D-Cache operation is cheaper. The lines
+ * are those of a scratch buffer of the D-Cache size from the heap. The size stays
+ * between a quarter of the D-Cache, since a whole flush also drops the lines of other
+ * data, and the D-Cache size, which it keeps without a cacheable scratch buffer.
+ */
+void ae350_dcache_calibrate(void)
+{
+	unsigned long line_size = cache_line_size();
+	unsigned long cache_size = cache_set(DCACHE) * cache_way(DCACHE) * line_size;
+	unsigned long start, t0, t_line, t_whole, size;
+	unsigned long saved_gie;
+	void *scratch;
+
+	if (!cache_size || !(read_csr(NDS_MMSC_CFG) & AE350_CCTLCSR))
+	{
+		cache_info.whole_size = 0;
+		return;
+	}
+
+	cache_info.whole_size = cache_size;
+
+	if (cache_size < CALIBRATE_LINES * line_size)
+	{
+		return;
+	}
+
+	// Line aligned scratch lines in cacheable memory
+	scratch = mem_malloc_region(cache_size + line_size, MEM_REGION_DDR);
+	if (!scratch)
+	{
+		scratch = mem_malloc_region(cache_size + line_size, MEM_REGION_DEFAULT);
+	}
+
+	if (!scratch)
+	{
+		return;
+	}
+
+	start = ROUND_UP((unsigned long)scratch, line_size);
+
+	if (ae350_mem_attr(start, cache_size) == MEM_ATTR_CACHEABLE)
+	{
+		saved_gie = GIE_SAVE();
+
+		ae350_dcache_dirty(start, cache_size, line_size);
+
+		t0 = read_csr(NDS_MCYCLE);
+		ae350_l1c_dcache_writeback_range(start, CALIBRATE_LINES * line_size);
+		t_line = read_csr(NDS_MCYCLE) - t0;
+
+		ae350_dcache_dirty(start, CALIBRATE_LINES * line_size, line_size);
+
+		t0 = read_csr(NDS_MCYCLE);
+		write_csr(NDS_MCCTLCOMMAND, CCTL_L1D_WB_ALL);
+		t_whole = read_csr(NDS_MCYCLE) - t0;
+
+		GIE_RESTORE(saved_gie);
+
+		// Bytes the line loop moves in the time of the whole D-Cache operation
+		size = t_line ? (t_whole * CALIBRATE_LINES / t_line) * line_size : cache_size;
+
+		if (size < cache_size / 4)
+		{
+			size = cache_size / 4;
+		}
+		else if (size > cache_size)
+		{
+			size = cache_size;
+		}
+
+		cache_info.whole_size = size;
+	}
+
+	mem_free(scratch);
+}
+
 // D-Cache flush all
 void ae350_dcache_flush_all(void)
 {
@@ -360,10 +466,77 @@ static void ae350_dcache_invalidate_partial_line(unsigned long start, unsigned l
 	}
 }
 
-// DMA write back range
+// Check if a DMA range is cheaper as a whole D-Cache operation, interrupts disabled
+static ALWAYS_INLINE int ae350_dma_use_whole(unsigned long size)
+{
+	if (cache_info.whole_size && (size >= cache_info.whole_size))
+	{
+		cctl_stats.whole++;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Invalidate the whole lines of a DMA destination, interrupts disabled. A large
+ * range writes back and invalidates the whole D-Cache instead, INVAL_ALL would drop
+ * the dirty data of other lines. The range holds no dirty data, it is invalidated
+ * before the transfer and not written by the CPU until the end.
+ */
+static void ae350_dma_dcache_invalidate_lines(unsigned long start, unsigned long size)
+{
+	if (ae350_dma_use_whole(size))
+	{
+		ae350_l1c_dcache_flush_all();
+	}
+	else
+	{
+		ae350_l1c_dcache_invalidate_range(start, size);	// L1 D-Cache
+	}
+}
+
+// DMA write back range, a large range writes back the whole D-Cache
 void ae350_dma_writeback_range(unsigned long start, unsigned long size)
 {
-	ae350_dcache_writeback_range(start, size);
+	unsigned long saved_gie;
+
+	if (!cache_info.is_init)
+	{
+		get_cache_info();
+	}
+
+	saved_gie = GIE_SAVE();
+
+	if (ae350_dma_use_whole(size))
+	{
+		write_csr(NDS_MCCTLCOMMAND, CCTL_L1D_WB_ALL);	// Other dirty lines are written back too
+	}
+	else
+	{
+		ae350_l1c_dcache_writeback_range(start, size);	// L1 D-Cache
+	}
+
+	GIE_RESTORE(saved_gie);
+}
+
+/*
+ * ae350_dma_invalidate_lines(start, size)
+ *
+ * Invalidate a DMA destination of whole cache lines, see ae350_dma_is_line_safe().
+ */
+void ae350_dma_invalidate_lines(unsigned long start, unsigned long size)
+{
+	unsigned long saved_gie;
+
+	if (!cache_info.is_init)
+	{
+		get_cache_info();
+	}
+
+	saved_gie = GIE_SAVE();
+	ae350_dma_dcache_invalidate_lines(start, size);
+	GIE_RESTORE(saved_gie);
 }
 
 /*
@@ -393,7 +566,7 @@ void ae350_dma_invalidate_range(unsigned long start, unsigned long size)
 		}
 		if (aligned_start < aligned_end)
 		{
-			ae350_dcache_invalidate_range(aligned_start, aligned_end - aligned_start);
+			ae350_dma_dcache_invalidate_lines(aligned_start, aligned_end - aligned_start);
 		}
 		if (aligned_end < end)
 		{
@@ -431,7 +604,7 @@ void ae350_dma_invalidate_range2(unsigned long start, unsigned long size)
 		}
 		if (aligned_start < aligned_end)
 		{
-			ae350_dcache_invalidate_range(aligned_start, aligned_end - aligned_start);
+			ae350_dma_dcache_invalidate_lines(aligned_start, aligned_end - aligned_start);
 		}
 		if (aligned_end < end)
 		{
@@ -441,3 +614,303 @@ void ae350_dma_invalidate_range2(unsigned long start, unsigned long size)
 
 	GIE_RESTORE(saved_gie);
 }
+
+/*
+ * ae350_dma_set_line_safe(start, size)
+ *
+ * Register the region of cache line aligned and padded DMA buffers. Line aligned
+ * ranges in it are invalidated by whole lines, without partial line handling.
+ */
+void ae350_dma_set_line_safe(unsigned long start, unsigned long size)
+{
+	dma_line_safe.start = start;
+	dma_line_safe.end = start + size;
+}
+
+
+/* Memory attributes */
+
+/*
+ * The table is built once from the configuration CSRs: the ILM and DLM at their
+ * MILMB/MDLMB base and at the slave port base the linker scripts use, the NAPOT
+ * entries of the programmable PMA, then the DDR, cacheable while the D-Cache is
+ * enabled. Anything else is device space. ae350_mem_attr_add() puts regions in
+ * front of them.
+ */
+
+#define MMSC_CFG_PPMA				(1UL << 30)		// Programmable PMA
+#define MCACHE_CTL_DC_EN			(1UL << 1)		// D-Cache enable
+#define LMB_BASE_MASK				(~0x3FFUL)		// MILMB, MDLMB base address
+#define PMA_ENTRIES					16
+#define PMA_ETYP_NAPOT				3
+#define PMA_MTYP_WT_FIRST			4				// Write-through memory types
+#define PMA_MTYP_WT_LAST			5
+#define PMA_MTYP_WB_FIRST			8				// Write-back memory types
+#define DDR_CACHEABLE_LAST			0x7FFFFFFFUL	// Cacheable memory of the PMA reset value
+
+struct _mem_attr_table mem_attr_table = {.is_init = 0};
+
+// Local memory size of MICM_CFG or MDCM_CFG, 0 for none
+static unsigned long mem_attr_lm_size(unsigned long lm_cfg)
+{
+	unsigned long lmsz = (lm_cfg >> 15) & 0x1F;
+
+	if (!lmsz || lmsz > 20)
+	{
+		return 0;	// Reserved size! treat as 0!
+	}
+
+	return 1UL << (9 + lmsz);
+}
+
+// Add a region behind the others
+static void mem_attr_append(unsigned long start, unsigned long last, unsigned long attr)
+{
+	if (mem_attr_table.num >= MEM_ATTR_REGIONS)
+	{
+		return;
+	}
+
+	mem_attr_table.region[mem_attr_table.num].start = start;
+	mem_attr_table.region[mem_attr_table.num].last = last;
+	mem_attr_table.region[mem_attr_table.num].attr = attr;
+	mem_attr_table.num++;
+}
+
+// Add a local memory at its core base and its slave port base
+static void mem_attr_append_lm(unsigned long lmb, unsigned long lm_cfg, unsigned long port_base)
+{
+	unsigned long size = mem_attr_lm_size(lm_cfg);
+
+	if (!(lmb & 0x1) || !size)
+	{
+		return;
+	}
+
+	mem_attr_append(lmb & LMB_BASE_MASK, (lmb & LMB_BASE_MASK) + size - 1, MEM_ATTR_LOCAL);
+
+	if ((lmb & LMB_BASE_MASK) != port_base)
+	{
+		mem_attr_append(port_base, port_base + size - 1, MEM_ATTR_LOCAL);
+	}
+}
+
+// Configuration byte of a PMA entry
+static unsigned long pma_cfg(unsigned int i)
+{
+	unsigned long cfg;
+
+#if __riscv_xlen == 64
+	cfg = (i < 8) ? read_csr(NDS_PMACFG0) : read_csr(NDS_PMACFG2);
+
+	return (cfg >> ((i & 7) * 8)) & 0xFF;
+#else
+	switch (i >> 2)
+	{
+	case 0:  cfg = read_csr(NDS_PMACFG0); break;
+	case 1:  cfg = read_csr(NDS_PMACFG1); break;
+	case 2:  cfg = read_csr(NDS_PMACFG2); break;
+	default: cfg = read_csr(NDS_PMACFG3); break;
+	}
+
+	return (cfg >> ((i & 3) * 8)) & 0xFF;
+#endif
+}
+
+// Address register of a PMA entry
+static unsigned long pma_addr(unsigned int i)
+{
+	switch (i)
+	{
+	case 0:  return read_csr(NDS_PMAADDR0);
+	case 1:  return read_csr(NDS_PMAADDR1);
+	case 2:  return read_csr(NDS_PMAADDR2);
+	case 3:  return read_csr(NDS_PMAADDR3);
+	case 4:  return read_csr(NDS_PMAADDR4);
+	case 5:  return read_csr(NDS_PMAADDR5);
+	case 6:  return read_csr(NDS_PMAADDR6);
+	case 7:  return read_csr(NDS_PMAADDR7);
+	case 8:  return read_csr(NDS_PMAADDR8);
+	case 9:  return read_csr(NDS_PMAADDR9);
+	case 10: return read_csr(NDS_PMAADDR10);
+	case 11: return read_csr(NDS_PMAADDR11);
+	case 12: return read_csr(NDS_PMAADDR12);
+	case 13: return read_csr(NDS_PMAADDR13);
+	case 14: return read_csr(NDS_PMAADDR14);
+	default: return read_csr(NDS_PMAADDR15);
+	}
+}
+
+// Add the NAPOT entries of the programmable PMA
+static void mem_attr_append_pma(void)
+{
+	unsigned long cfg, addr, ones, mtyp, attr, start;
+	unsigned int i;
+
+	for (i = 0; i < PMA_ENTRIES; i++)
+	{
+		cfg = pma_cfg(i);
+		if ((cfg & 0x3) != PMA_ETYP_NAPOT)
+		{
+			continue;
+		}
+
+		// NAPOT: trailing ones give the size, 8 bytes and up
+		addr = pma_addr(i);
+		ones = __builtin_ctzl(~addr | (1UL << (__riscv_xlen - 2)));
+		if (ones >= __riscv_xlen - 2)
+		{
+			continue;	// Beyond the address space, the default applies
+		}
+
+		mtyp = (cfg >> 2) & 0xF;
+		if (mtyp >= PMA_MTYP_WB_FIRST)
+		{
+			attr = MEM_ATTR_CACHEABLE;
+		}
+		else if (mtyp >= PMA_MTYP_WT_FIRST && mtyp <= PMA_MTYP_WT_LAST)
+		{
+			attr = MEM_ATTR_CLEAN;
+		}
+		else
+		{
+			attr = MEM_ATTR_NONCACHEABLE;
+		}
+
+		// The size of the whole address space wraps to 0, the last byte does not
+		start = (addr & ~((1UL << ones) - 1)) << 2;
+		mem_attr_append(start, start + ((8UL << ones) - 1), attr);
+	}
+}
+
+// Build the memory attribute table
+void ae350_mem_attr_init(void)
+{
+	/* Critical Section */
+	unsigned long saved_gie = GIE_SAVE();
+
+	/* Check the table has been initialized again in the critical section. */
+	if (!mem_attr_table.is_init)
+	{
+		mem_attr_table.num = 0;
+
+		mem_attr_append_lm(read_csr(NDS_MILMB), read_csr(NDS_MICM_CFG), ILM_BASE);
+		mem_attr_append_lm(read_csr(NDS_MDLMB), read_csr(NDS_MDCM_CFG), DLM_BASE);
+
+		// Without a D-Cache nothing needs maintenance
+		if (cache_line_size() && (read_csr(NDS_MCACHE_CTL) & MCACHE_CTL_DC_EN))
+		{
+			if (read_csr(NDS_MMSC_CFG) & MMSC_CFG_PPMA)
+			{
+				mem_attr_append_pma();
+			}
+
+			mem_attr_append(DDRMEM_BASE, DDR_CACHEABLE_LAST, MEM_ATTR_CACHEABLE);
+		}
+
+		/* Finish initialization */
+		mem_attr_table.is_init = 1;
+	}
+
+	GIE_RESTORE(saved_gie);
+}
+
+/*
+ * ae350_mem_attr_add(start, size, attr)
+ *
+ * Put a region in front of the table, e.g. a buffer the CPU never writes as
+ * MEM_ATTR_CLEAN. Returns 0, or -1 when the table is full.
+ */
+int ae350_mem_attr_add(unsigned long start, unsigned long size, unsigned long attr)
+{
+	unsigned long saved_gie;
+	int i;
+
+	if (!mem_attr_table.is_init)
+	{
+		ae350_mem_attr_init();
+	}
+
+	if ((size == 0) || (attr > MEM_ATTR_LOCAL) || (mem_attr_table.num >= MEM_ATTR_REGIONS))
+	{
+		return -1;
+	}
+
+	saved_gie = GIE_SAVE();
+
+	for (i = mem_attr_table.num; i > 0; i--)
+	{
+		mem_attr_table.region[i] = mem_attr_table.region[i - 1];
+	}
+
+	mem_attr_table.region[0].start = start;
+	mem_attr_table.region[0].last = start + size - 1;
+	mem_attr_table.region[0].attr = attr;
+	mem_attr_table.num++;
+
+	GIE_RESTORE(saved_gie);
+
+	return 0;
+}
+
+/*
+ * ae350_mem_attr(start, size)
+ *
+ * Attribute of a range. The first region it overlaps decides, a range not
+ * wholly in that region is taken as cacheable.
+ */
+int ae350_mem_attr(unsigned long start, unsigned long size)
+{
+	unsigned long last = start + (size ? size - 1 : 0);
+	const struct _mem_attr_region *r;
+	unsigned int i;
+
+	if (!mem_attr_table.is_init)
+	{
+		ae350_mem_attr_init();
+	}
+
+	for (i = 0; i < mem_attr_table.num; i++)
+	{
+		r = &mem_attr_table.region[i];
+
+		if ((start <= r->last) && (r->start <= last))
+		{
+			return ((start >= r->start) && (last <= r->last)) ? (int)r->attr : MEM_ATTR_CACHEABLE;
+		}
+	}
+
+	return MEM_ATTR_NONCACHEABLE;
+}
+
+// Check if a DMA source range needs a D-Cache write back
+int ae350_dma_need_writeback(unsigned long start, unsigned long size)
+{
+	if (ae350_mem_attr(start, size) == MEM_ATTR_CACHEABLE)
+	{
+		cctl_stats.writeback++;
+		return 1;
+	}
+
+	cctl_stats.writeback_skipped++;
+	return 0;
+}
+
+// Check if a DMA destination range needs a D-Cache invalidation
+int ae350_dma_need_invalidate(unsigned long start, unsigned long size)
+{
+	if (ae350_mem_attr(start, size) <= MEM_ATTR_CLEAN)
+	{
+		cctl_stats.invalidate++;
+		return 1;
+	}
+
+	cctl_stats.invalidate_skipped++;
+	return 0;
+}
+
+// D-Cache maintenance statistics of the DMA paths
+void ae350_cctl_get_stats(struct _cctl_stats *stats)
+{
+	*stats = cctl_stats;
+}
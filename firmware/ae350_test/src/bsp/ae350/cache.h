@@ -21,11 +21,61 @@
 struct _cache_info
 {
 	unsigned char is_init;				// Initialized flag
+	unsigned char vcctl;				// CCTL begin address auto-increments, MMSC_CFG.VCCTL
 	unsigned long cacheline_size;		// L1 cache line size
+	unsigned long iset;					// I-Cache sets
+	unsigned long iway;					// I-Cache ways
+	unsigned long dset;					// D-Cache sets
+	unsigned long dway;					// D-Cache ways
+	unsigned long whole_size;			// DMA ranges from this size use a whole D-Cache operation, 0 for never
 };
 
 extern struct _cache_info cache_info;
 
+// DMA buffers whose cache lines are not shared with other data, see mem_malloc_dma()
+struct _dma_line_safe
+{
+	unsigned long start;
+	unsigned long end;
+};
+
+extern struct _dma_line_safe dma_line_safe;
+
+// Memory attributes of a range, see ae350_mem_attr()
+#define MEM_ATTR_CACHEABLE		0	// Write-back cacheable, DMA needs write back and invalidation
+#define MEM_ATTR_CLEAN			1	// Cacheable but never dirty (write-through), DMA needs invalidation only
+#define MEM_ATTR_NONCACHEABLE	2	// Device or non-cacheable memory, or D-Cache disabled
+#define MEM_ATTR_LOCAL			3	// ILM/DLM, never cached
+
+// Memory attribute table, first match wins
+#define MEM_ATTR_REGIONS		12
+
+struct _mem_attr_region
+{
+	unsigned long start;
+	unsigned long last;					// Last byte, a region may end at the top of the address space
+	unsigned long attr;
+};
+
+struct _mem_attr_table
+{
+	unsigned char is_init;				// Initialized flag
+	unsigned char num;					// Regions in use
+	struct _mem_attr_region region[MEM_ATTR_REGIONS];
+};
+
+extern struct _mem_attr_table mem_attr_table;
+
+// D-Cache maintenance of the DMA paths
+struct _cctl_stats
+{
+	unsigned long writeback;			// Write backs done
+	unsigned long writeback_skipped;	// Write backs skipped by the memory attributes
+	unsigned long invalidate;			// Invalidations done
+	unsigned long invalidate_skipped;	// Invalidations skipped by the memory attributes
+	unsigned long whole;				// D-Cache ranges done by a whole D-Cache operation
+};
+
 extern void get_cache_info(void);
 
 // Get L1 cache line size
@@ -39,6 +89,14 @@ static inline __attribute__((always_inline)) unsigned long cache_line_size()
 	return cache_info.cacheline_size;
 }
 
+// Check if a DMA range is whole cache lines of buffers owning them. A range ending inside a
+// line may share it with data the CPU wrote, e.g. a tile of a frame buffer.
+static inline __attribute__((always_inline)) int ae350_dma_is_line_safe(unsigned long start, unsigned long size)
+{
+	return !((start | size) & (cache_line_size() - 1)) &&
+		   (start >= dma_line_safe.start) && (start + size <= dma_line_safe.end);
+}
+
 
 /* L1 cache operations */
 // I-Cache
@@ -50,11 +108,22 @@ extern void ae350_dcache_writeback_range(unsigned long start, unsigned long size
 extern void ae350_dcache_invalidate_range(unsigned long start, unsigned long size);
 extern void ae350_dcache_flush_range(unsigned long start, unsigned long size);
 extern void ae350_dcache_flush_all(void);
+extern void ae350_dcache_calibrate(void);
 
 /* DMA-specific operations */
 extern void ae350_dma_writeback_range(unsigned long start, unsigned long size);
 extern void ae350_dma_invalidate_range(unsigned long start, unsigned long size);
 extern void ae350_dma_invalidate_range2(unsigned long start, unsigned long size);
+extern void ae350_dma_invalidate_lines(unsigned long start, unsigned long size);
+extern void ae350_dma_set_line_safe(unsigned long start, unsigned long size);
+
+/* Memory attributes */
+extern void ae350_mem_attr_init(void);
+extern int ae350_mem_attr_add(unsigned long start, unsigned long size, unsigned long attr);
+extern int ae350_mem_attr(unsigned long start, unsigned long size);
+extern int ae350_dma_need_writeback(unsigned long start, unsigned long size);
+extern int ae350_dma_need_invalidate(unsigned long start, unsigned long size);
+extern void ae350_cctl_get_stats(struct _cctl_stats *stats);
 
 
 #endif /* __CACHE_H__ */
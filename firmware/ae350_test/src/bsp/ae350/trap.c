@@ -12,6 +12,7 @@
 // Includes ---------------------------------------------------------------------------------
 #include <stdio.h>
 #include "platform.h"
+#include "uart.h"
 
 
 // Definitions ------------------------------------------------------------------------------
@@ -40,6 +41,9 @@ __attribute__((weak)) long except_handler(long cause, long epc)
 	/* Unhandled Trap */
 	printf("Unhandled Trap : mcause = 0x%x, mepc = 0x%x\n", (unsigned int)cause, (unsigned int)epc);
 
+	/* Console output is buffered, send it before going on */
+	uart_flush();
+
 	return epc;
 }
 
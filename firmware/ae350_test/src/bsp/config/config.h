@@ -27,6 +27,9 @@
 // L1 cache select
 #define CFG_CACHE_ENABLE
 
+// DMA telemetry select
+//#define CFG_DMA_STATS	// Per-channel DMA counters and completion latency of dma_channel_get_stats()
+
 // Build mode select
 // The BUILD_MODE can be specified to BUILD_XIP/BUILD_BURN/BUILD_LOAD only.
 /*
@@ -64,17 +67,22 @@
 // Configuration settings for Driver GPIO
 #define DRV_GPIO						1		// Enable/disable GPIO	1: enable; 0: disable
 
+/*
+ * The DMA channels below are preferred ones: a driver requests its channel when initialized
+ * and gets another free one when it is taken, so drivers may share a preferred channel.
+ */
+
 /* I2C (Inter-integrated circuit interface) */
 // Configuration settings for Driver I2C
 #define DRV_I2C                         1		// Enable/disable I2C	1: enable; 0: disable
 // I2C with DMA
 // TX
 #define DRV_I2C_DMA_TX_EN               0		// Enable/disable I2C DMA TX	1: enable; 0: disable
-#define DRV_I2C_DMA_TX_CH               2		// DMA channel number of I2C TX
+#define DRV_I2C_DMA_TX_CH               2		// Preferred DMA channel of I2C TX
 #define DRV_I2C_DMA_TX_REQID            8		// DMA request id of I2C TX
 // RX
 #define DRV_I2C_DMA_RX_EN               0		// Enable/disable I2C DMA RX	1: enable; 0: disable
-#define DRV_I2C_DMA_RX_CH               3		// DMA channel number of I2C RX
+#define DRV_I2C_DMA_RX_CH               3		// Preferred DMA channel of I2C RX
 #define DRV_I2C_DMA_RX_REQID            8		// DMA request id of I2C RX
 
 /* UART1 (Universal asynchronous receiver transmitter) */
@@ -83,11 +91,11 @@
 // UART1 with DMA
 // TX
 #define DRV_UART1_DMA_TX_EN             1		// Enable/disable UART1 DMA TX	1: enable; 0: disable
-#define DRV_UART1_DMA_TX_CH             0		// DMA channel number of UART1 TX
+#define DRV_UART1_DMA_TX_CH             0		// Preferred DMA channel of UART1 TX
 #define DRV_UART1_DMA_TX_REQID          4		// DMA request id of UART1 TX
 // RX
 #define DRV_UART1_DMA_RX_EN             1		// Enable/disable UART1 DMA RX	1: enable; 0: disable
-#define DRV_UART1_DMA_RX_CH             1		// DMA channel number of UART1 RX
+#define DRV_UART1_DMA_RX_CH             1		// Preferred DMA channel of UART1 RX
 #define DRV_UART1_DMA_RX_REQID          5		// DMA request id of UART1 RX
 
 /* UART2 (Universal asynchronous receiver transmitter) */
@@ -96,11 +104,11 @@
 // UART2 with DMA
 // TX
 #define DRV_UART2_DMA_TX_EN             1		// Enable/disable UART2 DMA TX	1: enable; 0: disable
-#define DRV_UART2_DMA_TX_CH             0		// DMA channel number of UART2 TX
+#define DRV_UART2_DMA_TX_CH             0		// Preferred DMA channel of UART2 TX
 #define DRV_UART2_DMA_TX_REQID          6		// DMA request id of UART2 TX
 // RX
 #define DRV_UART2_DMA_RX_EN             1		// Enable/disable UART2 DMA RX	1: enable; 0: disable
-#define DRV_UART2_DMA_RX_CH             1		// DMA channel number of UART2 RX
+#define DRV_UART2_DMA_RX_CH             1		// Preferred DMA channel of UART2 RX
 #define DRV_UART2_DMA_RX_REQID          7		// DMA request id of UART2 RX
 
 /* SPI (Serial peripheral interface) */
@@ -109,11 +117,11 @@
 // SPI with DMA
 // TX
 #define DRV_SPI_DMA_TX_EN               0		// Enable/disable SPI DMA TX	1: enable; 0: disable
-#define DRV_SPI_DMA_TX_CH               0		// DMA channel number of SPI TX
+#define DRV_SPI_DMA_TX_CH               0		// Preferred DMA channel of SPI TX
 #define DRV_SPI_DMA_TX_REQID            2		// DMA request id of SPI TX
 // RX
 #define DRV_SPI_DMA_RX_EN               0		// Enable/disable SPI DMA RX	1: enable; 0: disable
-#define DRV_SPI_DMA_RX_CH               1		// DMA channel number of SPI RX
+#define DRV_SPI_DMA_RX_CH               1		// Preferred DMA channel of SPI RX
 #define DRV_SPI_DMA_RX_REQID            3		// DMA request id of SPI RX
 
 /* PWM (Pulse width modulator) */
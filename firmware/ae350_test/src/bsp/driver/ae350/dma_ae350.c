@@ -25,31 +25,86 @@ typedef struct
 	uint32_t           DstAddr;
 	uint32_t           Size;
 	uint32_t           Cnt;
+	const DMA_LLP_DESC *Llp;               // Descriptor chain, NULL for a single transfer
 	DMA_SignalEvent_t  cb_event;
 } DMA_Channel_Info;
 
 static uint32_t channel_active = 0U;
 static uint32_t init_cnt       = 0U;
 
+// Channels owned by dma_channel_request() and their priority hints
+static uint32_t channel_alloc  = 0U;
+static uint32_t channel_prio   = 0U;
+static DMA_ALLOC_STATS alloc_stats;
+
+// Priority of the transfers of a channel
+#define DMA_CH_PRIORITY(ch)  ((channel_prio & (1U << (ch))) ? DMA_CH_CTRL_PRIORITY_HIGH : 0U)
+
 static DMA_Channel_Info channel_info[DMA_NUMBER_OF_CHANNELS];
-#define DMA_CHANNEL(n)  ((DMA_CHANNEL_REG *)&(DEV_DMA->CHANNEL[n]))
 
-#ifdef CFG_CACHE_ENABLE
-#define DRAM_START   0x00000000U
-#define DRAM_END     0x7FFFFFFFU
-#define IS_ADDR_IN_RAM(addr) ((addr >= DRAM_START) && (addr <= DRAM_END))
-#endif
+// Submit queue, the head transfer is running
+typedef struct
+{
+	DMA_XFER           *head;
+	DMA_XFER           *tail;
+} DMA_Channel_Queue;
+
+static DMA_Channel_Queue channel_queue[DMA_NUMBER_OF_CHANNELS];
+#define DMA_CHANNEL(n)  ((DMA_CHANNEL_REG *)&(DEV_DMA->CHANNEL[n]))
 
 #ifdef CFG_CACHE_ENABLE
-#define DMA_DCACHE_WRITEBACK(start, size)        ae350_dma_writeback_range(start, size)
-#define DMA_DCACHE_INVALID(start, size)          ae350_dma_invalidate_range(start, size)
-#define DMA_DCACHE_INVALID_AFTER(start, size)    ae350_dma_invalidate_range2(start, size)
+// The memory attribute table skips local, non-cacheable and never dirty ranges.
+// Whole lines of buffers from mem_malloc_dma() are invalidated without partial line handling
+#define DMA_DCACHE_WRITEBACK(start, size)        do { if (ae350_dma_need_writeback(start, size)) \
+                                                      ae350_dma_writeback_range(start, size); } while (0)
+#define DMA_DCACHE_INVALID(start, size)          do { if (ae350_dma_need_invalidate(start, size)) \
+                                                      (ae350_dma_is_line_safe(start, size) ? \
+                                                       ae350_dma_invalidate_lines(start, size) : \
+                                                       ae350_dma_invalidate_range(start, size)); } while (0)
+#define DMA_DCACHE_INVALID_AFTER(start, size)    do { if (ae350_dma_need_invalidate(start, size)) \
+                                                      (ae350_dma_is_line_safe(start, size) ? \
+                                                       ae350_dma_invalidate_lines(start, size) : \
+                                                       ae350_dma_invalidate_range2(start, size)); } while (0)
 #else
 #define DMA_DCACHE_WRITEBACK(start, size)        NULL
 #define DMA_DCACHE_INVALID(start, size)          NULL
 #define DMA_DCACHE_INVALID_AFTER(start, size)    NULL
 #endif
 
+// DMA data width of DMACFG, 0: 32 bits .. 3: 256 bits
+#define DMA_CFG_DATA_WIDTH(cfg)  (((cfg) >> 24) & 0x3U)
+
+// Max transfer size of a descriptor
+#define DMA_MAX_TRANSIZE         0x3FFFFFU
+
+// Peripheral FIFOs by request number, single bytes until set
+static DMA_FIFO_INFO dma_fifo[DMA_NUMBER_OF_REQUESTS];
+
+// Copy requests in progress
+static DMA_COPY *copy_handle[DMA_NUMBER_OF_CHANNELS];
+
+// Next descriptor of a chain
+#define DMA_LLP_NEXT(desc)  ((const DMA_LLP_DESC *)(long)(desc)->llp_l)
+
+// Bytes of a descriptor, the transfer size is in units of the source width
+#define DMA_LLP_BYTES(desc) ((desc)->transize << (((desc)->ctrl & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS))
+
+// Bytes of a queued transfer
+#define DMA_XFER_BYTES(xfer) ((xfer)->size << (((xfer)->control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS))
+
+#ifdef CFG_DMA_STATS
+// Telemetry, the running transfer of a channel started at channel_stamp with channel_bytes
+static DMA_CHANNEL_STATS channel_stats[DMA_NUMBER_OF_CHANNELS];
+static uint32_t channel_stamp[DMA_NUMBER_OF_CHANNELS];
+static uint32_t channel_bytes[DMA_NUMBER_OF_CHANNELS];
+
+#define DMA_STATS_START(ch, bytes)   do { channel_stamp[ch] = read_csr(NDS_MCYCLE); channel_bytes[ch] = (bytes); } while (0)
+#define DMA_STATS_DONE(ch, event)    dma_stats_done (ch, event, channel_bytes[ch], channel_stamp[ch])
+#else
+#define DMA_STATS_START(ch, bytes)   do { } while (0)
+#define DMA_STATS_DONE(ch, event)    do { } while (0)
+#endif
+
 
 // Definitions ------------------------------------------------------------------------------
 
@@ -73,6 +128,8 @@ __inline static int32_t set_channel_active_flag (uint8_t ch)
 
 	if (channel_active & (1U << ch))
 	{
+		alloc_stats.busy++;
+
 		if (gie)
 		{
 			/* Enable interrupts in general. */
@@ -116,6 +173,99 @@ __inline static void clear_channel_active_flag (uint8_t ch)
 	}
 }
 
+#ifdef CFG_CACHE_ENABLE
+/**********************************************************************
+  \fn          void dma_llp_invalidate_after (const DMA_LLP_DESC *desc)
+  \brief       Invalidate the memory destinations of a chain
+  \param[in]   desc      First descriptor of the chain, NULL for none
+*********************************************************************/
+static void dma_llp_invalidate_after (const DMA_LLP_DESC *desc)
+{
+	for (; desc != NULL; desc = DMA_LLP_NEXT(desc))
+	{
+		if (((desc->ctrl & DMA_CH_CTRL_DMODE_HANDSHAKE) == 0U) &&
+			((desc->ctrl & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_INC))
+		{
+			DMA_DCACHE_INVALID_AFTER(desc->dst_addr_l, DMA_LLP_BYTES(desc));
+		}
+	}
+}
+#endif
+
+#ifdef CFG_DMA_STATS
+/**********************************************************************
+  \fn          void dma_stats_done (uint8_t ch, uint32_t event, uint32_t bytes, uint32_t stamp)
+  \brief       Count the end of a transfer in the telemetry of its channel
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   event     DMA event
+  \param[in]   bytes     Bytes of the transfer
+  \param[in]   stamp     'mcycle' of the configure or submit
+*********************************************************************/
+static void dma_stats_done (uint8_t ch, uint32_t event, uint32_t bytes, uint32_t stamp)
+{
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	DMA_CHANNEL_STATS *stats = &channel_stats[ch];
+	uint32_t lat = (uint32_t)read_csr(NDS_MCYCLE) - stamp;
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	if (event == DMA_EVENT_ERROR)
+	{
+		stats->errors++;
+	}
+	else if (event == DMA_EVENT_ABORT)
+	{
+		stats->aborts++;
+	}
+	else
+	{
+		stats->transfers++;
+		stats->bytes  += bytes;
+		stats->cycles += lat;
+
+		if (lat < stats->lat_min)
+		{
+			stats->lat_min = lat;
+		}
+
+		if (lat > stats->lat_max)
+		{
+			stats->lat_max = lat;
+		}
+
+		stats->lat_hist[lat ? (31 - __builtin_clz (lat)) : 0]++;
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+}
+
+/**********************************************************************
+  \fn          uint32_t dma_llp_bytes (const DMA_LLP_DESC *desc)
+  \brief       Bytes of a chain
+  \param[in]   desc      First descriptor of the chain
+  \returns     Bytes
+*********************************************************************/
+static uint32_t dma_llp_bytes (const DMA_LLP_DESC *desc)
+{
+	uint32_t bytes = 0U;
+
+	for (; desc != NULL; desc = DMA_LLP_NEXT(desc))
+	{
+		bytes += DMA_LLP_BYTES(desc);
+	}
+
+	return bytes;
+}
+#endif
+
 /**********************************************************************
   \fn          int32_t dma_initialize (void)
   \brief       Initialize DMA peripheral
@@ -146,11 +296,16 @@ int32_t dma_initialize (void)
 		channel_info[ch_num].DstAddr  = 0U;
 		channel_info[ch_num].Size     = 0U;
 		channel_info[ch_num].Cnt      = 0U;
+		channel_info[ch_num].Llp      = NULL;
+		channel_queue[ch_num].head    = NULL;
+		channel_queue[ch_num].tail    = NULL;
 	}
 
 	// Clear all DMA interrupt flags
 	DEV_DMA->INTSTATUS = 0xFFFFFF;
 
+	dma_channel_reset_stats (DMA_CHANNEL_ANY);
+
 	// Priority must be set > 0 to trigger the interrupt
 	__nds__plic_set_priority(IRQ_DMA_SOURCE, 1);
 
@@ -193,6 +348,233 @@ int32_t dma_uninitialize (void)
 	return 0;
 }
 
+/**********************************************************************
+  \fn          int32_t dma_channel_request (uint8_t ch, uint32_t priority)
+  \brief       Own a DMA channel until dma_channel_release().
+               The preferred channel is given when free, otherwise the
+               highest free one, so that the low channels stay for the
+               preferred channels of config.h.
+  \param[in]   ch        Preferred channel number (0..7), DMA_CHANNEL_ANY for none
+  \param[in]   priority  DMA_PRIO_NORMAL or DMA_PRIO_HIGH
+  \returns
+   - \b  0..7: channel number
+   - \b -1: no free channel
+*********************************************************************/
+int32_t dma_channel_request (uint8_t ch, uint32_t priority)
+{
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	int32_t n;
+
+	// Check if channel is valid
+	if ((ch >= DMA_NUMBER_OF_CHANNELS) && (ch != DMA_CHANNEL_ANY))
+	{
+		return -1;
+	}
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	alloc_stats.requests++;
+
+	// A channel started without request is not free either
+	if ((ch != DMA_CHANNEL_ANY) && !((channel_alloc | channel_active) & (1U << ch)))
+	{
+		n = ch;
+	}
+	else
+	{
+		for (n = DMA_NUMBER_OF_CHANNELS - 1; (n >= 0) && ((channel_alloc | channel_active) & (1U << n)); n--);
+
+		if (n < 0)
+		{
+			alloc_stats.failures++;
+		}
+		else if (ch != DMA_CHANNEL_ANY)
+		{
+			alloc_stats.fallbacks++;
+		}
+	}
+
+	if (n >= 0)
+	{
+		channel_alloc |= (1U << n);
+
+		if (priority == DMA_PRIO_HIGH)
+		{
+			channel_prio |= (1U << n);
+		}
+		else
+		{
+			channel_prio &= ~(1U << n);
+		}
+
+		alloc_stats.in_use++;
+		if (alloc_stats.in_use > alloc_stats.high_water)
+		{
+			alloc_stats.high_water = alloc_stats.in_use;
+		}
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	return n;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_release (uint8_t ch)
+  \brief       Give back a channel of dma_channel_request(), a transfer
+               still running on it is aborted
+  \param[in]   ch        Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_release (uint8_t ch)
+{
+	uint8_t gie;
+
+	// Check if channel is valid and owned
+	if ((ch >= DMA_NUMBER_OF_CHANNELS) || !(channel_alloc & (1U << ch)))
+	{
+		return -1;
+	}
+
+	if (channel_active & (1U << ch))
+	{
+		dma_channel_abort (ch);
+	}
+
+	gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	channel_alloc &= ~(1U << ch);
+	channel_prio  &= ~(1U << ch);
+	alloc_stats.in_use--;
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	return 0;
+}
+
+/**********************************************************************
+  \fn          void dma_alloc_get_stats (DMA_ALLOC_STATS *stats)
+  \brief       Get the channel allocation statistics
+  \param[out]  stats     Statistics
+*********************************************************************/
+void dma_alloc_get_stats (DMA_ALLOC_STATS *stats)
+{
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	*stats = alloc_stats;
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_get_stats (uint8_t ch, DMA_CHANNEL_STATS *stats)
+  \brief       Get the telemetry of a channel
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  stats     Statistics
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_get_stats (uint8_t ch, DMA_CHANNEL_STATS *stats)
+{
+#ifdef CFG_DMA_STATS
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+
+	if ((ch >= DMA_NUMBER_OF_CHANNELS) || (stats == NULL))
+	{
+		return -1;
+	}
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	*stats = channel_stats[ch];
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/**********************************************************************
+  \fn          void dma_channel_reset_stats (uint8_t ch)
+  \brief       Clear the telemetry of a channel
+  \param[in]   ch        Channel number (0..7), DMA_CHANNEL_ANY for all
+*********************************************************************/
+void dma_channel_reset_stats (uint8_t ch)
+{
+#ifdef CFG_DMA_STATS
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	static const DMA_CHANNEL_STATS none = { .lat_min = 0xFFFFFFFFU };
+	uint8_t first = ch, last = ch;
+
+	if (ch == DMA_CHANNEL_ANY)
+	{
+		first = 0U;
+		last  = DMA_NUMBER_OF_CHANNELS - 1U;
+	}
+	else if (ch >= DMA_NUMBER_OF_CHANNELS)
+	{
+		return;
+	}
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	for (ch = first; ch <= last; ch++)
+	{
+		channel_stats[ch] = none;
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+#endif
+}
+
 /**********************************************************************
   \fn          int32_t dma_channel_configure (uint8_t              ch,
                                               uint32_t             src_addr,
@@ -233,12 +615,12 @@ int32_t dma_channel_configure (	uint8_t            ch,
 	}
 
 #ifdef CFG_CACHE_ENABLE
-	if ((control & DMA_CH_CTRL_DMODE_HANDSHAKE) && IS_ADDR_IN_RAM(src_addr))
+	if (control & DMA_CH_CTRL_DMODE_HANDSHAKE)
 	{
 		DMA_DCACHE_WRITEBACK(src_addr, size);
 	}
 
-	if ((control & DMA_CH_CTRL_SMODE_HANDSHAKE) && IS_ADDR_IN_RAM(dst_addr))
+	if (control & DMA_CH_CTRL_SMODE_HANDSHAKE)
 	{
 		DMA_DCACHE_INVALID(dst_addr, size);
 	}
@@ -246,6 +628,7 @@ int32_t dma_channel_configure (	uint8_t            ch,
 
 	// Save callback pointer
 	channel_info[ch].cb_event = cb_event;
+	channel_info[ch].Llp      = NULL;
 
 	dma_ch = DMA_CHANNEL(ch);
 
@@ -257,7 +640,7 @@ int32_t dma_channel_configure (	uint8_t            ch,
 	DEV_DMA->INTSTATUS = (1U << (8+ch));
 	DEV_DMA->INTSTATUS = (1U << ch);
 
-	// Link list not supported
+	// Single transfer, see dma_channel_configure_llp() for a chain
 	dma_ch->LLPL = 0U;
 	dma_ch->LLPH = 0U;
 
@@ -308,6 +691,11 @@ int32_t dma_channel_configure (	uint8_t            ch,
 	channel_info[ch].DstAddr = dst_addr;
 	channel_info[ch].Cnt     = size;
 
+	// Priority hint of dma_channel_request()
+	control |= DMA_CH_PRIORITY(ch);
+
+	DMA_STATS_START(ch, channel_info[ch].Size << ((control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
+
 	// Compiler barrier to ensure channel_info[ch] is completed before setup DMA CTRL register.
 	// It is in RDS_V511 IDE.
 	asm volatile("" ::: "memory");
@@ -324,43 +712,1193 @@ int32_t dma_channel_configure (	uint8_t            ch,
 }
 
 /**********************************************************************
-  \fn          int32_t dma_channel_enable (uint8_t ch)
-  \brief       Enable DMA channel
-  \param[in]   ch Channel number (0..7)
+  \fn          int32_t dma_llp_build (DMA_LLP_DESC        *desc,
+                                      const DMA_SG_ENTRY  *sg,
+                                      uint32_t            num,
+                                      uint32_t            control)
+  \brief       Build a linked list descriptor chain of a scatter-gather list.
+               Only the last descriptor raises the terminal count interrupt.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   sg        Scatter-gather list
+  \param[in]   num       Number of entries in the list
+  \param[in]   control   Channel control of all entries
   \returns
    - \b  0: function succeeded
    - \b -1: function failed
 *********************************************************************/
-int32_t dma_channel_enable (uint8_t ch)
+int32_t dma_llp_build (	DMA_LLP_DESC        *desc,
+						const DMA_SG_ENTRY  *sg,
+						uint32_t            num,
+						uint32_t            control)
 {
-	// Check if channel is valid
-	if (ch >= DMA_NUMBER_OF_CHANNELS)
+	uint32_t i;
+
+	if ((desc == NULL) || (sg == NULL) || (num == 0U) || ((uint32_t)(long)desc & 7U))
 	{
 		return -1;
 	}
 
-	// Set Channel active flag
-	if (set_channel_active_flag (ch) == -1)
+	for (i = 0U; i < num; i++)
 	{
-		return -1;
+		// Max DMA transfer size = 4M, no chaining of zero sizes
+		if ((sg[i].size == 0U) || (sg[i].size > 0x3FFFFFU))
+		{
+			return -1;
+		}
+
+		desc[i].ctrl       = control | DMA_CH_CTRL_INTTC_MASK;
+		desc[i].transize   = sg[i].size;
+		desc[i].src_addr_l = sg[i].src_addr;
+		desc[i].src_addr_h = 0U;
+		desc[i].dst_addr_l = sg[i].dst_addr;
+		desc[i].dst_addr_h = 0U;
+		desc[i].llp_l      = (uint32_t)(long)&desc[i + 1];
+		desc[i].llp_h      = 0U;
 	}
 
-	DMA_CHANNEL(ch)->CTRL |= DMA_CH_CTRL_ENABLE;
+	// End of the chain, the only terminal count interrupt
+	desc[num - 1].ctrl  = control;
+	desc[num - 1].llp_l = 0U;
 
 	return 0;
 }
 
 /**********************************************************************
-  \fn          int32_t dma_channel_disable (uint8_t ch)
-  \brief       Disable DMA channel
-  \param[in]   ch Channel number (0..7)
+  \fn          int32_t dma_fifo_set (uint8_t reqsel, uint8_t width, uint8_t burst)
+  \brief       Describe the FIFO of a handshake request for dma_xfer_build()
+  \param[in]   reqsel    Request number (0..15)
+  \param[in]   width     DMA_WIDTH_* of the data register
+  \param[in]   burst     DMA_BSIZE_* of the entries one request may move
   \returns
    - \b  0: function succeeded
    - \b -1: function failed
 *********************************************************************/
-int32_t dma_channel_disable (uint8_t ch)
+int32_t dma_fifo_set (uint8_t reqsel, uint8_t width, uint8_t burst)
 {
-	// Check if channel is valid
+	if ((reqsel >= DMA_NUMBER_OF_REQUESTS) || (width > DMA_WIDTH_EWORD) || (burst > DMA_BSIZE_1024))
+	{
+		return -1;
+	}
+
+	dma_fifo[reqsel].width = width;
+	dma_fifo[reqsel].burst = burst;
+
+	return 0;
+}
+
+/**********************************************************************
+  \fn          DMA_LLP_DESC *dma_xfer_desc (DMA_LLP_DESC  *desc,
+                                            uint32_t      *src_addr,
+                                            uint32_t      *dst_addr,
+                                            uint32_t      bytes,
+                                            uint32_t      control,
+                                            uint32_t      swidth,
+                                            uint32_t      dwidth,
+                                            uint32_t      bsize)
+  \brief       Fill a descriptor of dma_xfer_build() and advance the
+               incremented addresses past it
+  \param[out]  desc      Descriptor
+  \param[in]   src_addr  Source address
+  \param[in]   dst_addr  Destination address
+  \param[in]   bytes     Bytes, a multiple of both widths
+  \param[in]   control   Channel control without burst and widths
+  \param[in]   swidth    DMA_WIDTH_* of the source
+  \param[in]   dwidth    DMA_WIDTH_* of the destination
+  \param[in]   bsize     DMA_BSIZE_* of the source
+  \returns     Next descriptor
+*********************************************************************/
+static DMA_LLP_DESC *dma_xfer_desc (	DMA_LLP_DESC  *desc,
+										uint32_t      *src_addr,
+										uint32_t      *dst_addr,
+										uint32_t      bytes,
+										uint32_t      control,
+										uint32_t      swidth,
+										uint32_t      dwidth,
+										uint32_t      bsize)
+{
+	desc->ctrl       = control |
+					   DMA_CH_CTRL_SBSIZE(bsize) |
+					   DMA_CH_CTRL_SWIDTH(swidth) |
+					   DMA_CH_CTRL_DWIDTH(dwidth) |
+					   DMA_CH_CTRL_INTTC_MASK;
+	desc->transize   = bytes >> swidth;
+	desc->src_addr_l = *src_addr;
+	desc->src_addr_h = 0U;
+	desc->dst_addr_l = *dst_addr;
+	desc->dst_addr_h = 0U;
+	desc->llp_l      = (uint32_t)(long)(desc + 1);
+	desc->llp_h      = 0U;
+
+	if ((control & DMA_CH_CTRL_SRCADDRCTRL_MASK) == DMA_CH_CTRL_SRCADDR_INC)
+	{
+		*src_addr += bytes;
+	}
+
+	if ((control & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_INC)
+	{
+		*dst_addr += bytes;
+	}
+
+	return (desc + 1);
+}
+
+/**********************************************************************
+  \fn          uint32_t dma_xfer_burst (uint32_t cnt, uint32_t min)
+  \brief       Largest memory burst up to 16 that divides the number of
+               transfers, at least min
+  \param[in]   cnt       Number of transfers, a multiple of 1 << min
+  \param[in]   min       DMA_BSIZE_* the destination width needs
+  \returns     DMA_BSIZE_*
+*********************************************************************/
+static uint32_t dma_xfer_burst (uint32_t cnt, uint32_t min)
+{
+	uint32_t bsize = (min > DMA_BSIZE_16) ? min : DMA_BSIZE_16;
+
+	while ((bsize > min) && (cnt & ((1U << bsize) - 1U)))
+	{
+		bsize--;
+	}
+
+	return bsize;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_xfer_build (DMA_LLP_DESC  *desc,
+                                       uint32_t      num,
+                                       uint32_t      src_addr,
+                                       uint32_t      dst_addr,
+                                       uint32_t      size,
+                                       uint32_t      control)
+  \brief       Build the chain of a transfer with the widths and bursts of
+               the alignment. The bulk moves whole requests of the FIFO, or
+               the widest width of the memory alignment; the head up to the
+               alignment and the tail go in narrow descriptors of their own.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   src_addr  Source address
+  \param[in]   dst_addr  Destination address
+  \param[in]   size      Bytes to transfer
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_xfer_build (	DMA_LLP_DESC        *desc,
+							uint32_t            num,
+							uint32_t            src_addr,
+							uint32_t            dst_addr,
+							uint32_t            size,
+							uint32_t            control)
+{
+	const DMA_FIFO_INFO *fifo = NULL;
+	DMA_LLP_DESC *d = desc;
+	uint32_t bus, nw, mw, sw, dw, unit, mem, from;
+	uint32_t head, bulk, tail, max, n;
+
+	if ((desc == NULL) || (num == 0U) || (size == 0U) || ((uint32_t)(long)desc & 7U) ||
+		((control & DMA_CH_CTRL_SRCADDRCTRL_MASK) == DMA_CH_CTRL_SRCADDR_DEC) ||
+		((control & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_DEC))
+	{
+		return -1;
+	}
+
+	bus = DMA_WIDTH_WORD + DMA_CFG_DATA_WIDTH(DEV_DMA->DMACFG);
+	control &= ~(DMA_CH_CTRL_SBSIZE_MASK | DMA_CH_CTRL_SWIDTH_MASK | DMA_CH_CTRL_DWIDTH_MASK);
+
+	// The peripheral side of a handshake, the memory side is aligned
+	if (control & DMA_CH_CTRL_DMODE_HANDSHAKE)
+	{
+		fifo = &dma_fifo[(control & DMA_CH_CTRL_DSTREQ_MASK) >> DMA_CH_CTRL_DSTREQ_POS];
+		mem  = src_addr;
+	}
+	else if (control & DMA_CH_CTRL_SMODE_HANDSHAKE)
+	{
+		fifo = &dma_fifo[(control & DMA_CH_CTRL_SRCREQ_MASK) >> DMA_CH_CTRL_SRCREQ_POS];
+		mem  = dst_addr;
+	}
+	else
+	{
+		mem  = dst_addr;
+	}
+
+	if (fifo)
+	{
+		// A request moves 1 << unit bytes, the memory width can not exceed it
+		nw   = fifo->width;
+		unit = fifo->width + fifo->burst;
+		mw   = (unit < bus) ? unit : bus;
+	}
+	else
+	{
+		nw   = DMA_WIDTH_BYTE;
+		unit = bus;
+		mw   = bus;
+	}
+
+	// Whole FIFO entries only
+	if ((mem | size) & ((1U << nw) - 1U))
+	{
+		return -1;
+	}
+
+	head = (0U - mem) & ((1U << mw) - 1U);
+	if (head > size)
+	{
+		head = size;
+	}
+
+	if (fifo)
+	{
+		sw = (control & DMA_CH_CTRL_DMODE_HANDSHAKE) ? mw : nw;
+		dw = (control & DMA_CH_CTRL_DMODE_HANDSHAKE) ? nw : mw;
+	}
+	else
+	{
+		// The source width of its own alignment after the head, a fixed source stays
+		from = src_addr;
+		if ((control & DMA_CH_CTRL_SRCADDRCTRL_MASK) == DMA_CH_CTRL_SRCADDR_INC)
+		{
+			from += head;
+		}
+
+		for (sw = bus; (sw != DMA_WIDTH_BYTE) && (from & ((1U << sw) - 1U)); sw--);
+		dw   = mw;
+		unit = (sw > dw) ? sw : dw;
+	}
+
+	bulk = (size - head) & ~((1U << unit) - 1U);
+	if (bulk == 0U)
+	{
+		// Too short for the bulk, all narrow
+		head = size;
+	}
+	tail = size - head - bulk;
+
+	// Head
+	if (head != 0U)
+	{
+		d = dma_xfer_desc (d, &src_addr, &dst_addr, head, control, nw, nw,
+						   fifo ? DMA_BSIZE_1 : dma_xfer_burst (head >> nw, DMA_BSIZE_1));
+	}
+
+	// Bulk, split at the max transfer size in whole requests
+	max = (DMA_MAX_TRANSIZE & ~((1U << (unit - sw)) - 1U)) << sw;
+	for (; bulk != 0U; bulk -= n)
+	{
+		if (d == desc + num)
+		{
+			return -1;
+		}
+
+		n = (bulk > max) ? max : bulk;
+		d = dma_xfer_desc (d, &src_addr, &dst_addr, n, control, sw, dw,
+						   fifo ? (unit - sw) : dma_xfer_burst (n >> sw, unit - sw));
+	}
+
+	// Tail
+	if (tail != 0U)
+	{
+		if (d == desc + num)
+		{
+			return -1;
+		}
+
+		d = dma_xfer_desc (d, &src_addr, &dst_addr, tail, control, nw, nw,
+						   fifo ? DMA_BSIZE_1 : dma_xfer_burst (tail >> nw, DMA_BSIZE_1));
+	}
+
+	// End of the chain, the terminal count interrupt of the control
+	d--;
+	d->ctrl  = (d->ctrl & ~DMA_CH_CTRL_INTTC_MASK) | (control & DMA_CH_CTRL_INTTC_MASK);
+	d->llp_l = 0U;
+
+	return (int32_t)(d - desc + 1);
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_llp (uint8_t              ch,
+                                                  const DMA_LLP_DESC   *desc,
+                                                  DMA_SignalEvent_t    cb_event)
+  \brief       Configure DMA channel for a linked list descriptor chain.
+               The first descriptor is loaded into the channel registers,
+               the DMA reads the others from memory.
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   desc      First descriptor of the chain
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_configure_llp (	uint8_t              ch,
+									const DMA_LLP_DESC   *desc,
+									DMA_SignalEvent_t    cb_event)
+{
+	DMA_CHANNEL_REG* dma_ch;
+
+	// Check if channel and chain are valid
+	if ((ch >= DMA_NUMBER_OF_CHANNELS) || (desc == NULL) || ((uint32_t)(long)desc & 7U))
+	{
+		return -1;
+	}
+
+	// Set Channel active flag
+	if (set_channel_active_flag (ch) == -1)
+	{
+		return -1;
+	}
+
+#ifdef CFG_CACHE_ENABLE
+	const DMA_LLP_DESC *d;
+
+	// The memory sides of every descriptor, a fixed memory address is up to the caller
+	for (d = desc; d != NULL; d = DMA_LLP_NEXT(d))
+	{
+		if (((d->ctrl & DMA_CH_CTRL_SMODE_HANDSHAKE) == 0U) &&
+			((d->ctrl & DMA_CH_CTRL_SRCADDRCTRL_MASK) == DMA_CH_CTRL_SRCADDR_INC))
+		{
+			DMA_DCACHE_WRITEBACK(d->src_addr_l, DMA_LLP_BYTES(d));
+		}
+
+		if (((d->ctrl & DMA_CH_CTRL_DMODE_HANDSHAKE) == 0U) &&
+			((d->ctrl & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_INC))
+		{
+			DMA_DCACHE_INVALID(d->dst_addr_l, DMA_LLP_BYTES(d));
+		}
+
+		// The DMA reads the descriptor from memory
+		if (d != desc)
+		{
+			DMA_DCACHE_WRITEBACK((uint32_t)(long)d, sizeof(DMA_LLP_DESC));
+		}
+	}
+#endif
+
+	// Save callback pointer and chain, a chain has no remaining data to restart
+	channel_info[ch].cb_event = cb_event;
+	channel_info[ch].Llp      = desc;
+	channel_info[ch].SrcAddr  = 0U;
+	channel_info[ch].DstAddr  = 0U;
+	channel_info[ch].Size     = 0U;
+	channel_info[ch].Cnt      = 0U;
+
+	dma_ch = DMA_CHANNEL(ch);
+
+	// Reset DMA Channel configuration
+	dma_ch->CTRL = 0U;
+
+	// Clear DMA interrupts status
+	DEV_DMA->INTSTATUS = (1U << (16+ch));
+	DEV_DMA->INTSTATUS = (1U << (8+ch));
+	DEV_DMA->INTSTATUS = (1U << ch);
+
+	// First descriptor
+	dma_ch->TRANSIZE = desc->transize;
+	dma_ch->SRCADDRL = desc->src_addr_l;
+	dma_ch->SRCADDRH = 0U;
+	dma_ch->DSTADDRL = desc->dst_addr_l;
+	dma_ch->DSTADDRH = 0U;
+	dma_ch->LLPL     = desc->llp_l;
+	dma_ch->LLPH     = 0U;
+
+	DMA_STATS_START(ch, dma_llp_bytes (desc));
+
+	// Compiler barrier to ensure channel_info[ch] is completed before setup DMA CTRL register.
+	asm volatile("" ::: "memory");
+
+	dma_ch->CTRL = desc->ctrl | DMA_CH_PRIORITY(ch);
+
+	if ((desc->ctrl & DMA_CH_CTRL_ENABLE) == 0U)
+	{
+		// Clear Channel active flag
+		clear_channel_active_flag (ch);
+	}
+
+	return 0;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_auto (uint8_t            ch,
+                                                   DMA_LLP_DESC       *desc,
+                                                   uint32_t           num,
+                                                   uint32_t           src_addr,
+                                                   uint32_t           dst_addr,
+                                                   uint32_t           size,
+                                                   uint32_t           control,
+                                                   DMA_SignalEvent_t  cb_event)
+  \brief       Configure DMA channel for a transfer of dma_xfer_build().
+               A transfer needing more than num descriptors goes as a
+               single transfer of the FIFO width, which the interrupt
+               handler restarts every 4M units.
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  desc      Array of num descriptors
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   src_addr  Source address
+  \param[in]   dst_addr  Destination address
+  \param[in]   size      Bytes to transfer
+  \param[in]   control   Channel control without burst and widths
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_configure_auto (	uint8_t              ch,
+										DMA_LLP_DESC         *desc,
+										uint32_t             num,
+										uint32_t             src_addr,
+										uint32_t             dst_addr,
+										uint32_t             size,
+										uint32_t             control,
+										DMA_SignalEvent_t    cb_event)
+{
+	const DMA_FIFO_INFO *fifo = NULL;
+	uint32_t width = DMA_WIDTH_BYTE;
+
+	if (dma_xfer_build (desc, num, src_addr, dst_addr, size, control) != -1)
+	{
+		return dma_channel_configure_llp (ch, desc, cb_event);
+	}
+
+	// Too long for the descriptors, the narrow width of the FIFO in chunks
+	if (control & DMA_CH_CTRL_DMODE_HANDSHAKE)
+	{
+		fifo = &dma_fifo[(control & DMA_CH_CTRL_DSTREQ_MASK) >> DMA_CH_CTRL_DSTREQ_POS];
+	}
+	else if (control & DMA_CH_CTRL_SMODE_HANDSHAKE)
+	{
+		fifo = &dma_fifo[(control & DMA_CH_CTRL_SRCREQ_MASK) >> DMA_CH_CTRL_SRCREQ_POS];
+	}
+
+	if (fifo)
+	{
+		width = fifo->width;
+	}
+
+	if ((size == 0U) || ((src_addr | dst_addr | size) & ((1U << width) - 1U)))
+	{
+		return -1;
+	}
+
+	control &= ~(DMA_CH_CTRL_SBSIZE_MASK | DMA_CH_CTRL_SWIDTH_MASK | DMA_CH_CTRL_DWIDTH_MASK);
+	control |= DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) | DMA_CH_CTRL_SWIDTH(width) | DMA_CH_CTRL_DWIDTH(width);
+
+	return dma_channel_configure (ch, src_addr, dst_addr, size >> width, control, cb_event);
+}
+
+/**********************************************************************
+  \fn          int32_t dma_2d_build_bus (DMA_LLP_DESC     *desc,
+                                         uint32_t         num,
+                                         const DMA_2D     *blk,
+                                         uint32_t         control,
+                                         uint32_t         bus)
+  \brief       Build the chain of a rectangular block, one descriptor per row
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   blk       Block
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \param[in]   bus       DMA_WIDTH_* of the data bus
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_2d_build_bus (	DMA_LLP_DESC     *desc,
+							uint32_t         num,
+							const DMA_2D     *blk,
+							uint32_t         control,
+							uint32_t         bus)
+{
+	DMA_LLP_DESC *d;
+	uint32_t src_addr, dst_addr, src, dst;
+	uint32_t align, width, bsize, i;
+
+	if ((desc == NULL) || (blk == NULL) || ((uint32_t)(long)desc & 7U) ||
+		(blk->width == 0U) || (blk->height == 0U) || (blk->height > num) || (bus > DMA_WIDTH_EWORD) ||
+		((control & DMA_CH_CTRL_SRCADDRCTRL_MASK) == DMA_CH_CTRL_SRCADDR_DEC) ||
+		((control & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_DEC))
+	{
+		return -1;
+	}
+
+	control &= ~(DMA_CH_CTRL_SBSIZE_MASK | DMA_CH_CTRL_SWIDTH_MASK | DMA_CH_CTRL_DWIDTH_MASK);
+
+	// Every row starts at the same alignment only if the strides keep it
+	align = blk->src_addr | blk->dst_addr | blk->width;
+	if (blk->height > 1U)
+	{
+		align |= blk->src_stride | blk->dst_stride;
+	}
+
+	for (width = bus; (width != DMA_WIDTH_BYTE) && (align & ((1U << width) - 1U)); width--);
+
+	if ((blk->width >> width) > DMA_MAX_TRANSIZE)
+	{
+		return -1;
+	}
+
+	bsize    = dma_xfer_burst (blk->width >> width, DMA_BSIZE_1);
+	src_addr = blk->src_addr;
+	dst_addr = blk->dst_addr;
+	d        = desc;
+
+	for (i = 0U; i < blk->height; i++)
+	{
+		src = src_addr;
+		dst = dst_addr;
+		d   = dma_xfer_desc (d, &src, &dst, blk->width, control, width, width, bsize);
+
+		src_addr += blk->src_stride;
+		dst_addr += blk->dst_stride;
+	}
+
+	// End of the chain, the terminal count interrupt of the control
+	d--;
+	d->ctrl  = (d->ctrl & ~DMA_CH_CTRL_INTTC_MASK) | (control & DMA_CH_CTRL_INTTC_MASK);
+	d->llp_l = 0U;
+
+	return (int32_t)blk->height;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_2d_build (DMA_LLP_DESC     *desc,
+                                     uint32_t         num,
+                                     const DMA_2D     *blk,
+                                     uint32_t         control)
+  \brief       Build the chain of a rectangular block for the data bus of
+               the DMA controller
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   blk       Block
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_2d_build (	DMA_LLP_DESC     *desc,
+						uint32_t         num,
+						const DMA_2D     *blk,
+						uint32_t         control)
+{
+	return dma_2d_build_bus (desc, num, blk, control, DMA_WIDTH_WORD + DMA_CFG_DATA_WIDTH(DEV_DMA->DMACFG));
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_2d (uint8_t            ch,
+                                                 DMA_LLP_DESC       *desc,
+                                                 uint32_t           num,
+                                                 const DMA_2D       *blk,
+                                                 DMA_SignalEvent_t  cb_event)
+  \brief       Configure DMA channel to copy a rectangular block from memory to memory
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  desc      Array of num descriptors
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   blk       Block
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_configure_2d (	uint8_t              ch,
+									DMA_LLP_DESC         *desc,
+									uint32_t             num,
+									const DMA_2D         *blk,
+									DMA_SignalEvent_t    cb_event)
+{
+	if (dma_2d_build (desc, num, blk,
+					  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+					  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+					  DMA_CH_CTRL_SRCADDR_INC |
+					  DMA_CH_CTRL_DSTADDR_INC |
+					  DMA_CH_CTRL_INTABT |
+					  DMA_CH_CTRL_INTERR |
+					  DMA_CH_CTRL_INTTC |
+					  DMA_CH_CTRL_ENABLE) == -1)
+	{
+		return -1;
+	}
+
+	return dma_channel_configure_llp (ch, desc, cb_event);
+}
+
+/**********************************************************************
+  \fn          void dma_xfer_invalidate_after (const DMA_XFER *xfer)
+  \brief       Invalidate the destination of a queued transfer filled by a peripheral
+  \param[in]   xfer      Transfer
+*********************************************************************/
+static void dma_xfer_invalidate_after (const DMA_XFER *xfer)
+{
+#ifdef CFG_CACHE_ENABLE
+	if ((xfer->control & DMA_CH_CTRL_SMODE_HANDSHAKE) &&
+		((xfer->control & DMA_CH_CTRL_DSTADDRCTRL_MASK) == DMA_CH_CTRL_DSTADDR_INC))
+	{
+		DMA_DCACHE_INVALID_AFTER(xfer->dst_addr, DMA_XFER_BYTES(xfer));
+	}
+#endif
+}
+
+/**********************************************************************
+  \fn          void dma_queue_start (uint8_t ch, const DMA_XFER *xfer)
+  \brief       Load a queued transfer into the idle channel and enable it
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   xfer      Transfer
+*********************************************************************/
+static void dma_queue_start (uint8_t ch, const DMA_XFER *xfer)
+{
+	DMA_CHANNEL_REG* dma_ch = DMA_CHANNEL(ch);
+
+	// The queue keeps the transfer, no remaining data to restart
+	channel_info[ch].cb_event = NULL;
+	channel_info[ch].Llp      = NULL;
+	channel_info[ch].SrcAddr  = 0U;
+	channel_info[ch].DstAddr  = 0U;
+	channel_info[ch].Size     = 0U;
+	channel_info[ch].Cnt      = 0U;
+
+	// Clear DMA interrupts status
+	DEV_DMA->INTSTATUS = (1U << (16+ch)) | (1U << (8+ch)) | (1U << ch);
+
+	dma_ch->TRANSIZE = xfer->size;
+	dma_ch->SRCADDRL = xfer->src_addr;
+	dma_ch->SRCADDRH = 0U;
+	dma_ch->DSTADDRL = xfer->dst_addr;
+	dma_ch->DSTADDRH = 0U;
+	dma_ch->LLPL     = 0U;
+	dma_ch->LLPH     = 0U;
+
+	// Compiler barrier to ensure channel_info[ch] is completed before setup DMA CTRL register.
+	asm volatile("" ::: "memory");
+
+	// The terminal count interrupt starts the next transfer
+	dma_ch->CTRL = (xfer->control & ~DMA_CH_CTRL_INTTC_MASK) | DMA_CH_PRIORITY(ch) | DMA_CH_CTRL_ENABLE;
+}
+
+/**********************************************************************
+  \fn          DMA_XFER *dma_queue_next (uint8_t ch, uint32_t event)
+  \brief       Complete the running transfer of a queue and start the
+               next one before any callback runs
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   event     DMA event of the running transfer
+  \returns     Completed transfer, its callback is not called yet
+*********************************************************************/
+static DMA_XFER *dma_queue_next (uint8_t ch, uint32_t event)
+{
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	DMA_XFER *xfer;
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	xfer = channel_queue[ch].head;
+	channel_queue[ch].head = xfer->next;
+
+	if (channel_queue[ch].head != NULL)
+	{
+		dma_queue_start (ch, channel_queue[ch].head);
+	}
+	else
+	{
+		channel_queue[ch].tail = NULL;
+
+		// Clear Channel active flag
+		clear_channel_active_flag (ch);
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	dma_xfer_invalidate_after (xfer);
+
+#ifdef CFG_DMA_STATS
+	dma_stats_done (ch, event, DMA_XFER_BYTES(xfer), xfer->stamp);
+#endif
+
+	xfer->next  = NULL;
+	xfer->event = event;
+
+	return xfer;
+}
+
+/**********************************************************************
+  \fn          void dma_queue_deliver (DMA_XFER *done)
+  \brief       Call the callbacks of a batch of completed transfers
+  \param[in]   done      Completed transfers linked in order
+*********************************************************************/
+static void dma_queue_deliver (DMA_XFER *done)
+{
+	DMA_XFER *xfer;
+
+	while (done != NULL)
+	{
+		// The callback may submit the transfer again
+		xfer = done;
+		done = xfer->next;
+		xfer->next = NULL;
+
+		if (xfer->cb_event)
+		{
+			xfer->cb_event (xfer, xfer->event);
+		}
+	}
+}
+
+/**********************************************************************
+  \fn          void dma_queue_cancel (uint8_t ch)
+  \brief       Drop the queue of a stopped channel, the callbacks get
+               DMA_EVENT_ABORT
+  \param[in]   ch        Channel number (0..7)
+*********************************************************************/
+static void dma_queue_cancel (uint8_t ch)
+{
+	uint8_t gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	DMA_XFER *done, *xfer;
+
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	done = channel_queue[ch].head;
+	channel_queue[ch].head = NULL;
+	channel_queue[ch].tail = NULL;
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	if (done == NULL)
+	{
+		return;
+	}
+
+	// Only the running transfer has data from the peripheral
+	dma_xfer_invalidate_after (done);
+
+#ifdef CFG_DMA_STATS
+	dma_stats_done (ch, DMA_EVENT_ABORT, 0U, 0U);
+#endif
+
+	for (xfer = done; xfer != NULL; xfer = xfer->next)
+	{
+		xfer->event = DMA_EVENT_ABORT;
+	}
+
+	dma_queue_deliver (done);
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_submit (uint8_t ch, DMA_XFER *xfer)
+  \brief       Queue a transfer on a channel. The interrupt of a terminal
+               count starts the next queued transfer at once, then calls
+               the callbacks of all the completed transfers in one batch.
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   xfer      Transfer, valid until its callback
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_submit (uint8_t ch, DMA_XFER *xfer)
+{
+	uint8_t gie;
+	int32_t ret = 0;
+
+	// Check if channel and transfer are valid, max DMA transfer size = 4M
+	if ((ch >= DMA_NUMBER_OF_CHANNELS) || (xfer == NULL) || (xfer->size == 0U) || (xfer->size > 0x3FFFFFU))
+	{
+		return -1;
+	}
+
+#ifdef CFG_CACHE_ENABLE
+	if (xfer->control & DMA_CH_CTRL_DMODE_HANDSHAKE)
+	{
+		DMA_DCACHE_WRITEBACK(xfer->src_addr, DMA_XFER_BYTES(xfer));
+	}
+
+	if (xfer->control & DMA_CH_CTRL_SMODE_HANDSHAKE)
+	{
+		DMA_DCACHE_INVALID(xfer->dst_addr, DMA_XFER_BYTES(xfer));
+	}
+#endif
+
+	xfer->event = 0U;
+	xfer->next  = NULL;
+#ifdef CFG_DMA_STATS
+	xfer->stamp = read_csr(NDS_MCYCLE);
+#endif
+
+	gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	if (channel_queue[ch].head != NULL)
+	{
+		channel_queue[ch].tail->next = xfer;
+		channel_queue[ch].tail       = xfer;
+	}
+	else if (channel_active & (1U << ch))
+	{
+		// Transfer of dma_channel_configure() running
+		alloc_stats.busy++;
+		ret = -1;
+	}
+	else
+	{
+		channel_active |= (1U << ch);
+		channel_queue[ch].head = xfer;
+		channel_queue[ch].tail = xfer;
+
+		dma_queue_start (ch, xfer);
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	return ret;
+}
+
+/**********************************************************************
+  \fn          void dma_channel_poll (uint8_t ch)
+  \brief       Complete the queued transfers of a channel that are done,
+               for callers waiting with interrupts disabled
+  \param[in]   ch        Channel number (0..7)
+*********************************************************************/
+void dma_channel_poll (uint8_t ch)
+{
+	uint8_t gie;
+	uint32_t status;
+	DMA_XFER *done = NULL;
+
+	// Check if channel is valid
+	if (ch >= DMA_NUMBER_OF_CHANNELS)
+	{
+		return;
+	}
+
+	gie = (read_csr(NDS_MSTATUS) & (1 << 3));
+	if (gie)
+	{
+		/* Disable global interrupt for core */
+		clear_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	status = DEV_DMA->INTSTATUS & ((1U << (16+ch)) | (1U << (8+ch)) | (1U << ch));
+
+	if ((channel_queue[ch].head != NULL) && (status != 0U))
+	{
+		// Clear interrupt flags, the interrupt finds nothing left
+		DEV_DMA->INTSTATUS = status;
+
+		if (status & (1U << ch))
+		{
+			DMA_CHANNEL(ch)->CTRL = 0U;
+			done = dma_queue_next (ch, DMA_EVENT_ERROR);
+		}
+		else if (status & (1U << (8+ch)))
+		{
+			DMA_CHANNEL(ch)->CTRL = 0U;
+			done = dma_queue_next (ch, DMA_EVENT_ABORT);
+		}
+		else
+		{
+			done = dma_queue_next (ch, DMA_EVENT_TERMINAL_COUNT_REQUEST);
+		}
+	}
+
+	if (gie)
+	{
+		/* Enable interrupts in general. */
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+	}
+
+	dma_queue_deliver (done);
+}
+
+/**********************************************************************
+  \fn          void dma_copy_event (uint8_t ch, uint32_t event)
+  \brief       Completion of a copy request
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   event     DMA event
+*********************************************************************/
+static void dma_copy_event (uint8_t ch, uint32_t event)
+{
+	DMA_COPY *copy = copy_handle[ch];
+
+	if (copy == NULL)
+	{
+		return;
+	}
+
+	copy_handle[ch] = NULL;
+
+	// The channel is free for the callback
+	if (copy->release)
+	{
+		dma_channel_release (ch);
+	}
+
+	copy->status = (event == DMA_EVENT_TERMINAL_COUNT_REQUEST) ? DMA_COPY_DONE : DMA_COPY_FAILED;
+
+	if (copy->cb_event)
+	{
+		copy->cb_event (copy);
+	}
+}
+
+// Channel callbacks of the copy requests
+static void dma_copy_event0 (uint32_t event) { dma_copy_event (0U, event); }
+static void dma_copy_event1 (uint32_t event) { dma_copy_event (1U, event); }
+static void dma_copy_event2 (uint32_t event) { dma_copy_event (2U, event); }
+static void dma_copy_event3 (uint32_t event) { dma_copy_event (3U, event); }
+static void dma_copy_event4 (uint32_t event) { dma_copy_event (4U, event); }
+static void dma_copy_event5 (uint32_t event) { dma_copy_event (5U, event); }
+static void dma_copy_event6 (uint32_t event) { dma_copy_event (6U, event); }
+static void dma_copy_event7 (uint32_t event) { dma_copy_event (7U, event); }
+
+static const DMA_SignalEvent_t copy_event[DMA_NUMBER_OF_CHANNELS] =
+{
+	dma_copy_event0, dma_copy_event1, dma_copy_event2, dma_copy_event3,
+	dma_copy_event4, dma_copy_event5, dma_copy_event6, dma_copy_event7
+};
+
+/**********************************************************************
+  \fn          int32_t dma_copy_start (DMA_COPY         *copy,
+                                       uint8_t          ch,
+                                       uint32_t         dst,
+                                       uint32_t         src,
+                                       uint32_t         size,
+                                       uint32_t         src_ctrl,
+                                       DMA_CopyEvent_t  cb_event)
+  \brief       Build the chain of a copy by dma_xfer_build() and start it.
+               The bulk moves in the widest widths of the alignment, the
+               unaligned head and tail go by bytes.
+  \param[out]  copy      Copy request
+  \param[in]   ch        Channel number (0..7), DMA_CHANNEL_ANY to request one
+  \param[in]   dst       Destination address
+  \param[in]   src       Source address
+  \param[in]   size      Bytes
+  \param[in]   src_ctrl  DMA_CH_CTRL_SRCADDR_INC or DMA_CH_CTRL_SRCADDR_FIX
+  \param[in]   cb_event  Completion callback
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+static int32_t dma_copy_start (	DMA_COPY         *copy,
+								uint8_t          ch,
+								uint32_t         dst,
+								uint32_t         src,
+								uint32_t         size,
+								uint32_t         src_ctrl,
+								DMA_CopyEvent_t  cb_event)
+{
+	int32_t i, n, req;
+
+	if ((copy == NULL) || (size == 0U) || ((ch >= DMA_NUMBER_OF_CHANNELS) && (ch != DMA_CHANNEL_ANY)))
+	{
+		return -1;
+	}
+
+	i = dma_xfer_build (copy->desc, DMA_COPY_MAX_DESC + 2U, src, dst, size,
+						DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+						DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+						src_ctrl |
+						DMA_CH_CTRL_DSTADDR_INC |
+						DMA_CH_CTRL_INTABT |
+						DMA_CH_CTRL_INTERR |
+						DMA_CH_CTRL_INTTC |
+						DMA_CH_CTRL_ENABLE);
+	if (i == -1)
+	{
+		return -1;
+	}
+
+	// A channel for this copy only
+	copy->release = (ch == DMA_CHANNEL_ANY);
+	if (copy->release)
+	{
+		req = dma_channel_request (DMA_CHANNEL_ANY, DMA_PRIO_NORMAL);
+		if (req == -1)
+		{
+			return -1;
+		}
+		ch = (uint8_t)req;
+	}
+
+	// Every descriptor carries the priority of the channel
+	for (n = 0; n < i; n++)
+	{
+		copy->desc[n].ctrl |= DMA_CH_PRIORITY(ch);
+	}
+
+	copy->dst      = dst;
+	copy->size     = size;
+	copy->cb_event = cb_event;
+	copy->ch       = ch;
+	copy->status   = DMA_COPY_BUSY;
+
+#ifdef CFG_CACHE_ENABLE
+	// The chain keeps the source and destination, the fixed pattern is ours
+	if (src_ctrl == DMA_CH_CTRL_SRCADDR_FIX)
+	{
+		DMA_DCACHE_WRITEBACK((uint32_t)(long)copy->pattern, sizeof(copy->pattern));
+	}
+#endif
+
+	copy_handle[ch] = copy;
+
+	if (dma_channel_configure_llp (ch, copy->desc, copy_event[ch]) == -1)
+	{
+		copy_handle[ch] = NULL;
+		copy->status = DMA_COPY_FAILED;
+
+		if (copy->release)
+		{
+			dma_channel_release (ch);
+		}
+
+		return -1;
+	}
+
+	return 0;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_memcpy_async (DMA_COPY          *copy,
+                                         uint8_t           ch,
+                                         void              *dst,
+                                         const void        *src,
+                                         uint32_t          size,
+                                         DMA_CopyEvent_t   cb_event)
+  \brief       Start a memory to memory copy of any size on a free channel.
+               The cache maintenance is done once for the whole copy.
+  \param[out]  copy      Copy request, status is DMA_COPY_BUSY until done
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  dst       Destination address
+  \param[in]   src       Source address
+  \param[in]   size      Bytes to copy
+  \param[in]   cb_event  Completion callback, NULL to poll
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_memcpy_async (	DMA_COPY			*copy,
+							uint8_t				ch,
+							void				*dst,
+							const void			*src,
+							uint32_t			size,
+							DMA_CopyEvent_t		cb_event)
+{
+	return dma_copy_start (copy, ch, (uint32_t)(long)dst, (uint32_t)(long)src, size, DMA_CH_CTRL_SRCADDR_INC, cb_event);
+}
+
+/**********************************************************************
+  \fn          int32_t dma_memset_async (DMA_COPY          *copy,
+                                         uint8_t           ch,
+                                         void              *dst,
+                                         int               c,
+                                         uint32_t          size,
+                                         DMA_CopyEvent_t   cb_event)
+  \brief       Start a memory fill of any size on a free channel.
+               The source is a pattern of the fill byte at a fixed address.
+  \param[out]  copy      Copy request, status is DMA_COPY_BUSY until done
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  dst       Destination address
+  \param[in]   c         Fill byte
+  \param[in]   size      Bytes to fill
+  \param[in]   cb_event  Completion callback, NULL to poll
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_memset_async (	DMA_COPY			*copy,
+							uint8_t				ch,
+							void				*dst,
+							int					c,
+							uint32_t			size,
+							DMA_CopyEvent_t		cb_event)
+{
+	uint32_t i;
+
+	if (copy == NULL)
+	{
+		return -1;
+	}
+
+	for (i = 0U; i < sizeof(copy->pattern) / sizeof(copy->pattern[0]); i++)
+	{
+		copy->pattern[i] = (c & 0xFFU) * 0x01010101U;
+	}
+
+	return dma_copy_start (copy, ch, (uint32_t)(long)dst, (uint32_t)(long)copy->pattern, size, DMA_CH_CTRL_SRCADDR_FIX, cb_event);
+}
+
+/**********************************************************************
+  \fn          int32_t dma_copy_wait (DMA_COPY *copy)
+  \brief       Wait until a copy is done
+  \param[in]   copy      Copy request
+  \returns
+   - \b  0: copy done
+   - \b -1: copy failed
+*********************************************************************/
+int32_t dma_copy_wait (DMA_COPY *copy)
+{
+	while (copy->status == DMA_COPY_BUSY);
+
+	return copy->status;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_enable (uint8_t ch)
+  \brief       Enable DMA channel
+  \param[in]   ch Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_enable (uint8_t ch)
+{
+	// Check if channel is valid
+	if (ch >= DMA_NUMBER_OF_CHANNELS)
+	{
+		return -1;
+	}
+
+	// Set Channel active flag
+	if (set_channel_active_flag (ch) == -1)
+	{
+		return -1;
+	}
+
+	// The transfer starts now
+	DMA_STATS_START(ch, channel_bytes[ch]);
+
+	DMA_CHANNEL(ch)->CTRL |= DMA_CH_CTRL_ENABLE;
+
+	return 0;
+}
+
+/**********************************************************************
+  \fn          int32_t dma_channel_disable (uint8_t ch)
+  \brief       Disable DMA channel
+  \param[in]   ch Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+int32_t dma_channel_disable (uint8_t ch)
+{
+	// Check if channel is valid
 	if (ch >= DMA_NUMBER_OF_CHANNELS)
 	{
 		return -1;
@@ -386,17 +1924,31 @@ int32_t dma_channel_disable (uint8_t ch)
 		}
 	}
 
-	if((control & DMA_CH_CTRL_SMODE_HANDSHAKE) && IS_ADDR_IN_RAM(dst_addr))
+	if(control & DMA_CH_CTRL_SMODE_HANDSHAKE)
 	{
 		DMA_DCACHE_INVALID_AFTER(dst_addr, size);
 	}
+
+	dma_llp_invalidate_after (channel_info[ch].Llp);
 #endif
 
+	// A queued transfer counts in the queue
+	if ((channel_active & (1U << ch)) && (channel_queue[ch].head == NULL))
+	{
+		DMA_STATS_DONE(ch, DMA_EVENT_ABORT);
+	}
+
 	// Clear Channel active flag
 	clear_channel_active_flag (ch);
 
 	DMA_CHANNEL(ch)->CTRL &= ~DMA_CH_CTRL_ENABLE;
 
+	// Queued transfers are dropped
+	dma_queue_cancel (ch);
+
+	// A copy in progress fails, dma_copy_wait() returns
+	dma_copy_event (ch, DMA_EVENT_ABORT);
+
 	return 0;
 }
 
@@ -436,12 +1988,20 @@ int32_t dma_channel_abort (uint8_t ch)
 		}
 	}
 
-	if((control & DMA_CH_CTRL_SMODE_HANDSHAKE) && IS_ADDR_IN_RAM(dst_addr))
+	if(control & DMA_CH_CTRL_SMODE_HANDSHAKE)
 	{
 		DMA_DCACHE_INVALID_AFTER(dst_addr, size);
 	}
+
+	dma_llp_invalidate_after (channel_info[ch].Llp);
 #endif
 
+	// A queued transfer counts in the queue
+	if ((channel_active & (1U << ch)) && (channel_queue[ch].head == NULL))
+	{
+		DMA_STATS_DONE(ch, DMA_EVENT_ABORT);
+	}
+
 	// Clear Channel active flag
 	clear_channel_active_flag (ch);
 
@@ -453,12 +2013,19 @@ int32_t dma_channel_abort (uint8_t ch)
 	channel_info[ch].DstAddr  = 0U;
 	channel_info[ch].Size     = 0U;
 	channel_info[ch].Cnt      = 0U;
+	channel_info[ch].Llp      = NULL;
 
 	// Clear DMA interrupts status
 	DEV_DMA->INTSTATUS = (1U << (16+ch));
 	DEV_DMA->INTSTATUS = (1U << (8+ch));
 	DEV_DMA->INTSTATUS = (1U << ch);
 
+	// Queued transfers are dropped
+	dma_queue_cancel (ch);
+
+	// A copy in progress fails, dma_copy_wait() returns
+	dma_copy_event (ch, DMA_EVENT_ABORT);
+
 	return 0;
 }
 
@@ -490,166 +2057,231 @@ uint32_t dma_channel_get_status (uint8_t ch)
 
 /**********************************************************************
   \fn          uint32_t dma_channel_get_count (uint8_t ch)
-  \brief       Get number of transferred data
+  \brief       Get number of transferred bytes
   \param[in]   ch Channel number (0..7)
-  \returns     Number of transferred data
+  \returns     Number of transferred bytes
 *********************************************************************/
 uint32_t dma_channel_get_count (uint8_t ch)
 {
+	const DMA_XFER *xfer;
+
 	// Check if channel is valid
 	if (ch >= DMA_NUMBER_OF_CHANNELS)
 	{
 		return 0;
 	}
 
-	return (channel_info[ch].Cnt - (DMA_CHANNEL(ch)->TRANSIZE & 0x3FFFFF));
+	// Queue, the running transfer
+	xfer = channel_queue[ch].head;
+	if (xfer)
+	{
+		return ((xfer->size - (DMA_CHANNEL(ch)->TRANSIZE & 0x3FFFFF)) <<
+				((xfer->control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
+	}
+
+	// Chain, the descriptors before the one in the channel are done, widths may differ
+	if (channel_info[ch].Llp)
+	{
+		const DMA_LLP_DESC *desc = channel_info[ch].Llp;
+		uint32_t cnt = 0U;
+		uint32_t next = DMA_CHANNEL(ch)->LLPL;
+
+		while ((desc->llp_l != next) && (desc->llp_l != 0U))
+		{
+			cnt += DMA_LLP_BYTES(desc);
+			desc = DMA_LLP_NEXT(desc);
+		}
+
+		return (cnt + ((desc->transize - (DMA_CHANNEL(ch)->TRANSIZE & 0x3FFFFF)) <<
+					   ((desc->ctrl & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS)));
+	}
+
+	// Single transfer, the chunks before the one in the channel are done
+	return ((channel_info[ch].Cnt - (DMA_CHANNEL(ch)->TRANSIZE & 0x3FFFFF)) <<
+			((DMA_CHANNEL(ch)->CTRL & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
 }
 
 /**********************************************************************
   \fn          void dma_irq_handler (void)
-  \brief       DMA interrupt handler
+  \brief       DMA interrupt handler. INTSTATUS is read and acknowledged
+               once, only the channels with an event are visited.
 *********************************************************************/
 void dma_irq_handler (void)
 {
-	uint32_t ch, size;
+	uint32_t status, pending, ch, size;
 	DMA_CHANNEL_REG * dma_ch;
+	DMA_XFER *done = NULL;
+	DMA_XFER **done_tail = &done;
+
+	// Error [7:0], abort [15:8] and terminal count [23:16] of all channels
+	status = DEV_DMA->INTSTATUS & 0xFFFFFFU;
+	if (status == 0U)
+	{
+		return;
+	}
+
+	// Clear interrupt flags, an event after the read stays pending
+	DEV_DMA->INTSTATUS = status;
+
+	// Channels with any event
+	pending = (status | (status >> 8) | (status >> 16)) & 0xFFU;
 
-	for (ch = 0; ch < DMA_NUMBER_OF_CHANNELS; ch++)
+	while (pending)
 	{
-		if ((DEV_DMA->INTSTATUS & (1U << ch)) == 0)
+		ch = __builtin_ctz (pending);
+		pending &= pending - 1U;
+
+		dma_ch = DMA_CHANNEL(ch);
+
+		// DMA error interrupt
+		if (status & (1U << ch))
 		{
-			dma_ch = DMA_CHANNEL(ch);
+			dma_ch->CTRL = 0U;
 
-			// Terminal count request interrupt
-			if (DEV_DMA->INTSTATUS & (1U << (16 + ch)))
+			if (channel_queue[ch].head != NULL)
+			{
+				*done_tail = dma_queue_next (ch, DMA_EVENT_ERROR);
+				done_tail  = &(*done_tail)->next;
+			}
+			else
 			{
-				// Clear interrupt flag
-				DEV_DMA->INTSTATUS = (1U << (16 + ch));
+				DMA_STATS_DONE(ch, DMA_EVENT_ERROR);
+
+				// Clear Channel active flag
+				clear_channel_active_flag (ch);
 
-				if (channel_info[ch].Cnt != channel_info[ch].Size)
+				// Signal Event
+				if (channel_info[ch].cb_event)
 				{
-					// Data waiting to transfer
-					uint32_t control;
-
-					size = channel_info[ch].Size - channel_info[ch].Cnt;
-					// Max DMA transfer size = 4M
-					if (size > 0x3FFFFFU)
-					{
-						size = 0x3FFFFFU;
-					}
-
-					channel_info[ch].Cnt += size;
-					control = dma_ch->CTRL;
-
-					if (!(control & DMA_CH_CTRL_SRCADDR_FIX))
-					{
-						dma_ch->SRCADDRL = channel_info[ch].SrcAddr;
-						dma_ch->SRCADDRH = 0U;
-						if (control & DMA_CH_CTRL_SRCADDR_DEC)
-						{
-							// Source address decrement
-							channel_info[ch].SrcAddr -= (size << ((control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
-						}
-						else
-						{
-							// Source address increment
-							channel_info[ch].SrcAddr += (size << ((control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
-						}
-					}
-					if (!(control & DMA_CH_CTRL_DSTADDR_FIX))
-					{
-						dma_ch->DSTADDRL = channel_info[ch].DstAddr;
-						dma_ch->DSTADDRH = 0U;
-						if (control & DMA_CH_CTRL_DSTADDR_DEC)
-						{
-							// Source address decrement
-							channel_info[ch].DstAddr -= (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
-						}
-						else
-						{
-							// Destination address increment
-							channel_info[ch].DstAddr += (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
-						}
-					}
-
-					// Set transfer size
-					dma_ch->TRANSIZE = size;
-					// Enable DMA Channel
-					dma_ch->CTRL |= DMA_CH_CTRL_ENABLE;
+					channel_info[ch].cb_event(DMA_EVENT_ERROR);
 				}
-				else
+			}
+		}
+		// DMA abort interrupt
+		else if (status & (1U << (8 + ch)))
+		{
+			dma_ch->CTRL = 0U;
+
+			if (channel_queue[ch].head != NULL)
+			{
+				*done_tail = dma_queue_next (ch, DMA_EVENT_ABORT);
+				done_tail  = &(*done_tail)->next;
+			}
+			else
+			{
+				DMA_STATS_DONE(ch, DMA_EVENT_ABORT);
+
+				// Clear Channel active flag
+				clear_channel_active_flag (ch);
+
+				// Signal Event
+				if (channel_info[ch].cb_event)
 				{
-					// All Data has been transferred
+					channel_info[ch].cb_event(DMA_EVENT_ABORT);
+				}
+			}
+		}
+		// Terminal count request interrupt
+		else if (channel_queue[ch].head != NULL)
+		{
+			// Next queued transfer, the callback goes with the batch
+			*done_tail = dma_queue_next (ch, DMA_EVENT_TERMINAL_COUNT_REQUEST);
+			done_tail  = &(*done_tail)->next;
+		}
+		else if (channel_info[ch].Cnt != channel_info[ch].Size)
+		{
+			// Data waiting to transfer
+			uint32_t control;
 
-#ifdef CFG_CACHE_ENABLE
-					uint32_t dst_addr = channel_info[ch].DstAddr;
-					uint32_t control = dma_ch->CTRL;
-					uint32_t size = channel_info[ch].Size;
-
-					if (!(control & DMA_CH_CTRL_DSTADDR_FIX))
-					{
-						if (control & DMA_CH_CTRL_DSTADDR_DEC)
-						{
-							// Source address increment to complement
-							dst_addr += (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
-						}
-						else
-						{
-							// Destination address decrement to complement
-							dst_addr -= (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
-						}
-					}
-
-					if((control & DMA_CH_CTRL_SMODE_HANDSHAKE) && IS_ADDR_IN_RAM(dst_addr))
-					{
-						DMA_DCACHE_INVALID_AFTER(dst_addr, size);
-					}
-#endif
-					// Clear Channel active flag
-					clear_channel_active_flag (ch);
-
-					// Signal Event
-					if (channel_info[ch].cb_event)
-					{
-						channel_info[ch].cb_event(DMA_EVENT_TERMINAL_COUNT_REQUEST);
-					}
+			size = channel_info[ch].Size - channel_info[ch].Cnt;
+			// Max DMA transfer size = 4M
+			if (size > 0x3FFFFFU)
+			{
+				size = 0x3FFFFFU;
+			}
+
+			channel_info[ch].Cnt += size;
+			control = dma_ch->CTRL;
+
+			if (!(control & DMA_CH_CTRL_SRCADDR_FIX))
+			{
+				dma_ch->SRCADDRL = channel_info[ch].SrcAddr;
+				dma_ch->SRCADDRH = 0U;
+				if (control & DMA_CH_CTRL_SRCADDR_DEC)
+				{
+					// Source address decrement
+					channel_info[ch].SrcAddr -= (size << ((control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
+				}
+				else
+				{
+					// Source address increment
+					channel_info[ch].SrcAddr += (size << ((control & DMA_CH_CTRL_SWIDTH_MASK) >> DMA_CH_CTRL_SWIDTH_POS));
 				}
 			}
-			else
+			if (!(control & DMA_CH_CTRL_DSTADDR_FIX))
+			{
+				dma_ch->DSTADDRL = channel_info[ch].DstAddr;
+				dma_ch->DSTADDRH = 0U;
+				if (control & DMA_CH_CTRL_DSTADDR_DEC)
+				{
+					// Source address decrement
+					channel_info[ch].DstAddr -= (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
+				}
+				else
+				{
+					// Destination address increment
+					channel_info[ch].DstAddr += (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
+				}
+			}
+
+			// Set transfer size
+			dma_ch->TRANSIZE = size;
+			// Enable DMA Channel
+			dma_ch->CTRL |= DMA_CH_CTRL_ENABLE;
+		}
+		else
+		{
+			// All Data has been transferred
+
+#ifdef CFG_CACHE_ENABLE
+			uint32_t dst_addr = channel_info[ch].DstAddr;
+			uint32_t control = dma_ch->CTRL;
+			uint32_t size = channel_info[ch].Size;
+
+			if (!(control & DMA_CH_CTRL_DSTADDR_FIX))
 			{
-				// DMA error interrupt
-				if (DEV_DMA->INTSTATUS & (1U << ch))
+				if (control & DMA_CH_CTRL_DSTADDR_DEC)
 				{
-					dma_ch->CTRL = 0U;
-					// Clear Channel active flag
-					clear_channel_active_flag (ch);
-
-					// Clear interrupt flag
-					DEV_DMA->INTSTATUS = (1U << ch);
-
-					// Signal Event
-					if (channel_info[ch].cb_event)
-					{
-						channel_info[ch].cb_event(DMA_EVENT_ERROR);
-					}
+					// Source address increment to complement
+					dst_addr += (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
 				}
-				// DMA abort interrupt
-				else if (DEV_DMA->INTSTATUS & (1U << (8 + ch)))
+				else
 				{
-					dma_ch->CTRL = 0U;
-					// Clear Channel active flag
-					clear_channel_active_flag (ch);
-
-					// Clear interrupt flag
-					DEV_DMA->INTSTATUS = (1U << (8 + ch));
-
-					// Signal Event
-					if (channel_info[ch].cb_event)
-					{
-						channel_info[ch].cb_event(DMA_EVENT_ABORT);
-					}
+					// Destination address decrement to complement
+					dst_addr -= (size << ((control & DMA_CH_CTRL_DWIDTH_MASK) >> DMA_CH_CTRL_DWIDTH_POS));
 				}
 			}
+
+			if(control & DMA_CH_CTRL_SMODE_HANDSHAKE)
+			{
+				DMA_DCACHE_INVALID_AFTER(dst_addr, size);
+			}
+
+			dma_llp_invalidate_after (channel_info[ch].Llp);
+#endif
+			DMA_STATS_DONE(ch, DMA_EVENT_TERMINAL_COUNT_REQUEST);
+
+			// Clear Channel active flag
+			clear_channel_active_flag (ch);
+
+			// Signal Event
+			if (channel_info[ch].cb_event)
+			{
+				channel_info[ch].cb_event(DMA_EVENT_TERMINAL_COUNT_REQUEST);
+			}
 		}
 	}
+
+	// Completions of the queues in one batch, every channel is already restarted
+	dma_queue_deliver (done);
 }
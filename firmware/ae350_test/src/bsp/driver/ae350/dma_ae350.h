@@ -12,6 +12,7 @@
 
 
 // Includes ---------------------------------------------------------------------------------
+#include <stddef.h>
 #include <stdint.h>
 #include "platform.h"
 
@@ -21,6 +22,16 @@
 // Number of DMA channels
 #define DMA_NUMBER_OF_CHANNELS           ((uint8_t) 8)
 
+// Any free channel of dma_channel_request()
+#define DMA_CHANNEL_ANY                  ((uint8_t) 0xFF)
+
+// Channel priority hints of dma_channel_request()
+#define DMA_PRIO_NORMAL                  (0)
+#define DMA_PRIO_HIGH                    (1)      // DMA_CH_CTRL_PRIORITY_HIGH on every transfer of the channel
+
+// Number of handshake request lines, SrcReqSel and DstReqSel
+#define DMA_NUMBER_OF_REQUESTS           ((uint8_t) 16)
+
 // GPDMA events
 #define DMA_EVENT_TERMINAL_COUNT_REQUEST (1)
 #define DMA_EVENT_ERROR                  (2)
@@ -89,8 +100,128 @@
 #define DMA_CH_CTRL_INTABT               (   0 << 3)													// [3] IntAbtMask
 #define DMA_CH_CTRL_INTERR               (   0 << 2)													// [2] IntErrMask
 #define DMA_CH_CTRL_INTTC                (   0 << 1)													// [1] IntTCMask
+#define DMA_CH_CTRL_INTTC_MASK           (   1 << 1)													// [1] IntTCMask, no terminal count interrupt
 #define DMA_CH_CTRL_ENABLE               (   1 << 0)													// [0] Enable
 
+// Linked list descriptor, loaded into the channel registers when the previous one completes
+typedef struct _DMA_LLP_DESC
+{
+	uint32_t ctrl;                       // Channel control
+	uint32_t transize;                   // Transfer size in units of the source width
+	uint32_t src_addr_l;                 // Source address
+	uint32_t src_addr_h;
+	uint32_t dst_addr_l;                 // Destination address
+	uint32_t dst_addr_h;
+	uint32_t llp_l;                      // Next descriptor, 0 at the end of the chain
+	uint32_t llp_h;
+} __attribute__((aligned(8))) DMA_LLP_DESC;
+
+// Scatter-gather list entry
+typedef struct _DMA_SG_ENTRY
+{
+	uint32_t src_addr;                   // Source address
+	uint32_t dst_addr;                   // Destination address
+	uint32_t size;                       // Amount of data in units of the source width
+} DMA_SG_ENTRY;
+
+// Peripheral FIFO of a handshake request, see dma_fifo_set()
+typedef struct _DMA_FIFO_INFO
+{
+	uint8_t                  width;                          // DMA_WIDTH_* of a FIFO entry
+	uint8_t                  burst;                          // DMA_BSIZE_* of the entries one request may move
+} DMA_FIFO_INFO;
+
+// Rectangular block of rows, see dma_2d_build()
+typedef struct _DMA_2D
+{
+	uint32_t                 src_addr;                       // Source address of the first row
+	uint32_t                 dst_addr;                       // Destination address of the first row
+	uint32_t                 width;                          // Bytes of a row
+	uint32_t                 height;                         // Number of rows
+	uint32_t                 src_stride;                     // Bytes from a source row to the next, two's complement upwards
+	uint32_t                 dst_stride;                     // Bytes from a destination row to the next, two's complement upwards
+} DMA_2D;
+
+// Descriptors of a driver transfer of dma_channel_configure_auto(): head, bulk and tail.
+// A longer transfer falls back to a single transfer chunked by the interrupt handler.
+#define DMA_XFER_DESC                    3
+
+// Descriptors of a copy, each moves up to 4M units of the widest width of the alignment
+#ifndef DMA_COPY_MAX_DESC
+#define DMA_COPY_MAX_DESC                8
+#endif
+
+// Copy status
+#define DMA_COPY_DONE                    (0)
+#define DMA_COPY_BUSY                    (1)
+#define DMA_COPY_FAILED                  (-1)
+
+typedef struct _DMA_COPY DMA_COPY;
+
+// Copy completion callback, called from the DMA interrupt
+typedef void (*DMA_CopyEvent_t) (DMA_COPY *copy);
+
+// Memory to memory copy request, valid until the copy is done
+struct _DMA_COPY
+{
+	DMA_LLP_DESC             desc[DMA_COPY_MAX_DESC + 2];    // Chain, two more for the unaligned head and tail
+	uint32_t                 pattern[8] __attribute__((aligned(32)));   // Source of a memset
+	uint32_t                 dst;                            // Destination address
+	uint32_t                 size;                           // Bytes
+	DMA_CopyEvent_t          cb_event;                       // Completion callback, NULL to poll
+	volatile int32_t         status;                         // DMA_COPY_BUSY until done
+	uint8_t                  ch;                             // DMA channel
+	uint8_t                  release;                        // Channel requested for this copy, released when done
+};
+
+typedef struct _DMA_XFER DMA_XFER;
+
+// Queued transfer completion callback, called from the DMA interrupt
+typedef void (*DMA_XferEvent_t) (DMA_XFER *xfer, uint32_t event);
+
+// Queued transfer, owned by the DMA driver from dma_channel_submit() until its callback
+struct _DMA_XFER
+{
+	uint32_t                 src_addr;                       // Source address
+	uint32_t                 dst_addr;                       // Destination address
+	uint32_t                 size;                           // Amount of data, up to 4M
+	uint32_t                 control;                        // Channel control, enabled when started
+	DMA_XferEvent_t          cb_event;                       // Completion callback, NULL for none
+	void                     *arg;                           // For the callback
+	volatile uint32_t        event;                          // DMA_EVENT_* when done, 0 while queued
+	DMA_XFER                 *next;                          // Queue link
+#ifdef CFG_DMA_STATS
+	uint32_t                 stamp;                          // 'mcycle' of dma_channel_submit()
+#endif
+};
+
+// Channel allocation statistics
+typedef struct _DMA_ALLOC_STATS
+{
+	uint32_t                 requests;       // Calls of dma_channel_request()
+	uint32_t                 fallbacks;      // Preferred channel owned, another one given
+	uint32_t                 failures;       // No free channel
+	uint32_t                 busy;           // Transfers refused, channel still active
+	uint32_t                 in_use;         // Channels owned now
+	uint32_t                 high_water;     // Maximum of in_use
+} DMA_ALLOC_STATS;
+
+// Log2 buckets of the completion latency, bucket n counts 2^n up to 2^(n+1)-1 cycles
+#define DMA_STATS_LAT_BUCKETS            32
+
+// Channel telemetry of CFG_DMA_STATS, the latency runs from the configure or submit to the interrupt
+typedef struct _DMA_CHANNEL_STATS
+{
+	uint32_t                 transfers;      // Transfers completed
+	uint32_t                 errors;         // Transfers ended by a bus error
+	uint32_t                 aborts;         // Transfers aborted or disabled
+	uint64_t                 bytes;          // Bytes of the completed transfers
+	uint64_t                 cycles;         // Sum of the latencies, the busy time of the channel
+	uint32_t                 lat_min;        // Shortest latency in 'mcycle', 0xFFFFFFFF for none
+	uint32_t                 lat_max;        // Longest latency in 'mcycle'
+	uint32_t                 lat_hist[DMA_STATS_LAT_BUCKETS];
+} DMA_CHANNEL_STATS;
+
 
 // Declarations  ---------------------------------------------------------------------------
 
@@ -120,6 +251,55 @@ extern int32_t dma_initialize (void);
 *********************************************************************/
 extern int32_t dma_uninitialize (void);
 
+/**********************************************************************
+  \fn          int32_t dma_channel_request (uint8_t ch, uint32_t priority)
+  \brief       Own a DMA channel until dma_channel_release().
+               The preferred channel is given when free, otherwise the
+               highest free one.
+  \param[in]   ch        Preferred channel number (0..7), DMA_CHANNEL_ANY for none
+  \param[in]   priority  DMA_PRIO_NORMAL or DMA_PRIO_HIGH
+  \returns
+   - \b  0..7: channel number
+   - \b -1: no free channel
+*********************************************************************/
+extern int32_t dma_channel_request (uint8_t ch, uint32_t priority);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_release (uint8_t ch)
+  \brief       Give back a channel of dma_channel_request(), a transfer
+               still running on it is aborted
+  \param[in]   ch        Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_channel_release (uint8_t ch);
+
+/**********************************************************************
+  \fn          void dma_alloc_get_stats (DMA_ALLOC_STATS *stats)
+  \brief       Get the channel allocation statistics
+  \param[out]  stats     Statistics
+*********************************************************************/
+extern void dma_alloc_get_stats (DMA_ALLOC_STATS *stats);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_get_stats (uint8_t ch, DMA_CHANNEL_STATS *stats)
+  \brief       Get the telemetry of a channel, kept with CFG_DMA_STATS
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  stats     Statistics
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed, or no CFG_DMA_STATS
+*********************************************************************/
+extern int32_t dma_channel_get_stats (uint8_t ch, DMA_CHANNEL_STATS *stats);
+
+/**********************************************************************
+  \fn          void dma_channel_reset_stats (uint8_t ch)
+  \brief       Clear the telemetry of a channel
+  \param[in]   ch        Channel number (0..7), DMA_CHANNEL_ANY for all
+*********************************************************************/
+extern void dma_channel_reset_stats (uint8_t ch);
+
 /**********************************************************************
   \fn          int32_t dma_channel_configure (uint8_t            ch,
                                               uint32_t           src_addr,
@@ -145,6 +325,277 @@ extern int32_t dma_channel_configure (	uint8_t				ch,
 										uint32_t			control,
 										DMA_SignalEvent_t	cb_event);
 
+/**********************************************************************
+  \fn          int32_t dma_llp_build (DMA_LLP_DESC        *desc,
+                                      const DMA_SG_ENTRY  *sg,
+                                      uint32_t            num,
+                                      uint32_t            control)
+  \brief       Build a linked list descriptor chain of a scatter-gather list.
+               Only the last descriptor raises the terminal count interrupt.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   sg        Scatter-gather list
+  \param[in]   num       Number of entries in the list
+  \param[in]   control   Channel control of all entries
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_llp_build (	DMA_LLP_DESC		*desc,
+								const DMA_SG_ENTRY	*sg,
+								uint32_t			num,
+								uint32_t			control);
+
+/**********************************************************************
+  \fn          int32_t dma_fifo_set (uint8_t reqsel, uint8_t width, uint8_t burst)
+  \brief       Describe the FIFO of a handshake request for dma_xfer_build().
+               The burst must fit the FIFO at the threshold the peripheral
+               raises the request at. Requests not set move single bytes.
+  \param[in]   reqsel    Request number (0..15)
+  \param[in]   width     DMA_WIDTH_* of the data register
+  \param[in]   burst     DMA_BSIZE_* of the entries one request may move
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_fifo_set (uint8_t reqsel, uint8_t width, uint8_t burst);
+
+/**********************************************************************
+  \fn          int32_t dma_xfer_build (DMA_LLP_DESC  *desc,
+                                       uint32_t      num,
+                                       uint32_t      src_addr,
+                                       uint32_t      dst_addr,
+                                       uint32_t      size,
+                                       uint32_t      control)
+  \brief       Build the chain of a transfer with the widths and bursts of
+               the alignment. A peripheral side moves its FIFO entries and
+               bursts by dma_fifo_set(), the memory side the widest width
+               one request holds. The unaligned head and tail go in narrow
+               descriptors of their own. Only the last descriptor raises
+               the terminal count interrupt.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   src_addr  Source address
+  \param[in]   dst_addr  Destination address
+  \param[in]   size      Bytes to transfer
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_xfer_build (	DMA_LLP_DESC		*desc,
+								uint32_t			num,
+								uint32_t			src_addr,
+								uint32_t			dst_addr,
+								uint32_t			size,
+								uint32_t			control);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_llp (uint8_t              ch,
+                                                  const DMA_LLP_DESC   *desc,
+                                                  DMA_SignalEvent_t    cb_event)
+  \brief       Configure DMA channel for a linked list descriptor chain.
+               The chain runs without the CPU, cb_event is called once at
+               the end of the chain. The descriptors must stay valid until then.
+               The D-cache of the incremented memory sides is kept here.
+               The priority of the channel only applies to the first
+               descriptor, the others keep the priority of their control.
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   desc      First descriptor of the chain
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_channel_configure_llp (	uint8_t				ch,
+											const DMA_LLP_DESC	*desc,
+											DMA_SignalEvent_t	cb_event);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_auto (uint8_t            ch,
+                                                   DMA_LLP_DESC       *desc,
+                                                   uint32_t           num,
+                                                   uint32_t           src_addr,
+                                                   uint32_t           dst_addr,
+                                                   uint32_t           size,
+                                                   uint32_t           control,
+                                                   DMA_SignalEvent_t  cb_event)
+  \brief       Configure DMA channel for a transfer of dma_xfer_build().
+               A transfer longer than the num descriptors allow goes as a
+               single transfer of the FIFO width, restarted every 4M units
+               by the interrupt handler.
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  desc      Array of num descriptors, valid until the end of the transfer
+  \param[in]   num       Number of descriptors in the array
+  \param[in]   src_addr  Source address
+  \param[in]   dst_addr  Destination address
+  \param[in]   size      Bytes to transfer
+  \param[in]   control   Channel control without burst and widths
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_channel_configure_auto (	uint8_t				ch,
+											DMA_LLP_DESC		*desc,
+											uint32_t			num,
+											uint32_t			src_addr,
+											uint32_t			dst_addr,
+											uint32_t			size,
+											uint32_t			control,
+											DMA_SignalEvent_t	cb_event);
+
+/**********************************************************************
+  \fn          int32_t dma_2d_build (DMA_LLP_DESC     *desc,
+                                     uint32_t         num,
+                                     const DMA_2D     *blk,
+                                     uint32_t         control)
+  \brief       Build the chain of a rectangular block, one descriptor per
+               row. The width is the widest one the addresses, the row
+               width and the strides allow. Only the last descriptor raises
+               the terminal count interrupt.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array, at least the height
+  \param[in]   blk       Block
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_2d_build (	DMA_LLP_DESC		*desc,
+								uint32_t			num,
+								const DMA_2D		*blk,
+								uint32_t			control);
+
+/**********************************************************************
+  \fn          int32_t dma_2d_build_bus (DMA_LLP_DESC     *desc,
+                                         uint32_t         num,
+                                         const DMA_2D     *blk,
+                                         uint32_t         control,
+                                         uint32_t         bus)
+  \brief       dma_2d_build() for a given data bus width. It touches no
+               register, so the chain can be checked off the target.
+  \param[out]  desc      Array of num descriptors, 8-byte aligned
+  \param[in]   num       Number of descriptors in the array, at least the height
+  \param[in]   blk       Block
+  \param[in]   control   Channel control, the burst and width fields are set here
+  \param[in]   bus       DMA_WIDTH_* of the data bus, the widest width used
+  \returns
+   - \b  1..num: number of descriptors
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_2d_build_bus (	DMA_LLP_DESC		*desc,
+									uint32_t			num,
+									const DMA_2D		*blk,
+									uint32_t			control,
+									uint32_t			bus);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_configure_2d (uint8_t            ch,
+                                                 DMA_LLP_DESC       *desc,
+                                                 uint32_t           num,
+                                                 const DMA_2D       *blk,
+                                                 DMA_SignalEvent_t  cb_event)
+  \brief       Configure DMA channel to copy a rectangular block from memory
+               to memory, e.g. a tile of a DDR frame to the DLM or every
+               Nth sample of a buffer. cb_event is called once after the
+               last row, dma_channel_get_count() counts the block in bytes.
+  \param[in]   ch        Channel number (0..7)
+  \param[out]  desc      Array of num descriptors, valid until the end of the transfer
+  \param[in]   num       Number of descriptors in the array, at least the height
+  \param[in]   blk       Block
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_channel_configure_2d (	uint8_t				ch,
+											DMA_LLP_DESC		*desc,
+											uint32_t			num,
+											const DMA_2D		*blk,
+											DMA_SignalEvent_t	cb_event);
+
+/**********************************************************************
+  \fn          int32_t dma_channel_submit (uint8_t ch, DMA_XFER *xfer)
+  \brief       Queue a transfer on a channel. The interrupt of a terminal
+               count starts the next queued transfer at once, then calls
+               the callbacks of all the completed transfers in one batch.
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   xfer      Transfer, valid until its callback
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_channel_submit (uint8_t ch, DMA_XFER *xfer);
+
+/**********************************************************************
+  \fn          void dma_channel_poll (uint8_t ch)
+  \brief       Complete the queued transfers of a channel that are done,
+               for callers waiting with interrupts disabled
+  \param[in]   ch        Channel number (0..7)
+*********************************************************************/
+extern void dma_channel_poll (uint8_t ch);
+
+/**********************************************************************
+  \fn          int32_t dma_memcpy_async (DMA_COPY          *copy,
+                                         uint8_t           ch,
+                                         void              *dst,
+                                         const void        *src,
+                                         uint32_t          size,
+                                         DMA_CopyEvent_t   cb_event)
+  \brief       Start a memory to memory copy of any size on a free channel.
+               The cache maintenance is done once for the whole copy.
+  \param[out]  copy      Copy request, status is DMA_COPY_BUSY until done
+  \param[in]   ch        Channel number (0..7), DMA_CHANNEL_ANY to request one for this copy
+  \param[out]  dst       Destination address
+  \param[in]   src       Source address
+  \param[in]   size      Bytes to copy
+  \param[in]   cb_event  Completion callback, NULL to poll
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_memcpy_async (	DMA_COPY			*copy,
+									uint8_t				ch,
+									void				*dst,
+									const void			*src,
+									uint32_t			size,
+									DMA_CopyEvent_t		cb_event);
+
+/**********************************************************************
+  \fn          int32_t dma_memset_async (DMA_COPY          *copy,
+                                         uint8_t           ch,
+                                         void              *dst,
+                                         int               c,
+                                         uint32_t          size,
+                                         DMA_CopyEvent_t   cb_event)
+  \brief       Start a memory fill of any size on a free channel
+  \param[out]  copy      Copy request, status is DMA_COPY_BUSY until done
+  \param[in]   ch        Channel number (0..7), DMA_CHANNEL_ANY to request one for this copy
+  \param[out]  dst       Destination address
+  \param[in]   c         Fill byte
+  \param[in]   size      Bytes to fill
+  \param[in]   cb_event  Completion callback, NULL to poll
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*********************************************************************/
+extern int32_t dma_memset_async (	DMA_COPY			*copy,
+									uint8_t				ch,
+									void				*dst,
+									int					c,
+									uint32_t			size,
+									DMA_CopyEvent_t		cb_event);
+
+/**********************************************************************
+  \fn          int32_t dma_copy_wait (DMA_COPY *copy)
+  \brief       Wait until a copy is done
+  \param[in]   copy      Copy request
+  \returns
+   - \b  0: copy done
+   - \b -1: copy failed
+*********************************************************************/
+extern int32_t dma_copy_wait (DMA_COPY *copy);
+
 /**********************************************************************
   \fn          int32_t dma_channel_enable (uint8_t ch)
   \brief       Enable DMA channel
@@ -157,7 +608,7 @@ extern int32_t dma_channel_enable (uint8_t ch);
 
 /**********************************************************************
   \fn          int32_t dma_channel_disable (uint8_t ch)
-  \brief       Disable DMA channel
+  \brief       Disable DMA channel, the queued transfers get DMA_EVENT_ABORT
   \param[in]   ch Channel number (0..7)
   \returns
    - \b  0: function succeeded
@@ -177,15 +628,16 @@ extern uint32_t dma_channel_get_status (uint8_t ch);
 
 /**********************************************************************
   \fn          uint32_t dma_channel_get_count (uint8_t ch)
-  \brief       Get number of transferred data
+  \brief       Get number of transferred bytes, of a single, queued or
+               chained transfer alike
   \param[in]   ch Channel number (0..7)
-  \returns     Number of transferred data
+  \returns     Number of transferred bytes
 *********************************************************************/
 extern uint32_t dma_channel_get_count (uint8_t ch);
 
 /**********************************************************************
   \fn          uint32_t dma_channel_abort (uint8_t ch)
-  \brief       Abort ch transfer
+  \brief       Abort ch transfer, the queued transfers get DMA_EVENT_ABORT
   \param[in]   ch Channel number (0..7)
   \returns
    - \b  0: function succeeded
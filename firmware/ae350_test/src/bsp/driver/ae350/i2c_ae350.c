@@ -33,8 +33,8 @@ static const AE350_I2C_CAPABILITIES DriverCapabilities =
 };
 
 #if (DRV_I2C)
-// I2C Control Information
-static I2C_INFO I2C_Info = {0};
+// I2C Control Information, no DMA channel owned before i2cx_initialize()
+static I2C_INFO I2C_Info = {.dma_tx_ch = DMA_CHANNEL_ANY, .dma_rx_ch = DMA_CHANNEL_ANY};
 
 #if (DRV_I2C_DMA_TX_EN == 1)
 void i2c_dma_tx_event (uint32_t event);
@@ -113,10 +113,55 @@ int32_t i2cx_initialize(AE350_I2C_SignalEvent_t cb_event, I2C_RESOURCES* i2c)
 	i2c->info->Pwr_State = AE350_POWER_FULL;
 	i2c->info->Status.direction = 0;
 
-	// DMA Initialize
+	// DMA Initialize, the channels are owned until uninitialize
 	if (i2c->dma_tx || i2c->dma_rx)
 	{
+		int32_t tx_ch = DMA_CHANNEL_ANY, rx_ch = DMA_CHANNEL_ANY;
+
 		dma_initialize();
+
+		if (i2c->dma_tx)
+		{
+			tx_ch = dma_channel_request(i2c->dma_tx->channel, DMA_PRIO_NORMAL);
+		}
+
+		if (i2c->dma_rx)
+		{
+			rx_ch = dma_channel_request(i2c->dma_rx->channel, DMA_PRIO_HIGH);
+		}
+
+		if ((tx_ch == -1) || (rx_ch == -1))
+		{
+			if (i2c->dma_tx && (tx_ch != -1))
+			{
+				dma_channel_release(tx_ch);
+			}
+
+			if (i2c->dma_rx && (rx_ch != -1))
+			{
+				dma_channel_release(rx_ch);
+			}
+
+			dma_uninitialize();
+
+			__nds__plic_disable_interrupt(IRQ_I2C_SOURCE);
+
+			return AE350_DRIVER_ERROR_BUSY;
+		}
+
+		i2c->info->dma_tx_ch = tx_ch;
+		i2c->info->dma_rx_ch = rx_ch;
+
+		// One data byte per request
+		if (i2c->dma_tx)
+		{
+			dma_fifo_set(i2c->dma_tx->reqsel, DMA_WIDTH_BYTE, DMA_BSIZE_1);
+		}
+
+		if (i2c->dma_rx)
+		{
+			dma_fifo_set(i2c->dma_rx->reqsel, DMA_WIDTH_BYTE, DMA_BSIZE_1);
+		}
 	}
 
 	i2c->info->Driver_State |= I2C_DRV_INIT;
@@ -141,20 +186,33 @@ int32_t i2cx_initialize(AE350_I2C_SignalEvent_t cb_event, I2C_RESOURCES* i2c)
 // Uninitialized
 int32_t i2cx_uninitialize(I2C_RESOURCES* i2c)
 {
-	// DMA Uninitialized
-	if (i2c->dma_tx || i2c->dma_rx)
+	// DMA Uninitialized, only when i2cx_initialize() got the channels
+	if ((i2c->info->dma_tx_ch != DMA_CHANNEL_ANY) || (i2c->info->dma_rx_ch != DMA_CHANNEL_ANY))
 	{
 		dma_uninitialize();
 
 		if (i2c->dma_tx && (i2c->info->Status.busy != 0))
 		{
-			dma_channel_disable(i2c->dma_tx->channel);
+			dma_channel_disable(i2c->info->dma_tx_ch);
 		}
 
 		if (i2c->dma_rx && (i2c->info->Status.busy != 0))
 		{
-			dma_channel_disable(i2c->dma_rx->channel);
+			dma_channel_disable(i2c->info->dma_rx_ch);
 		}
+
+		if (i2c->dma_tx)
+		{
+			dma_channel_release(i2c->info->dma_tx_ch);
+		}
+
+		if (i2c->dma_rx)
+		{
+			dma_channel_release(i2c->info->dma_rx_ch);
+		}
+
+		i2c->info->dma_tx_ch = DMA_CHANNEL_ANY;
+		i2c->info->dma_rx_ch = DMA_CHANNEL_ANY;
 	}
 
 	// Disable and clear DMA IRQ
@@ -186,12 +244,12 @@ int32_t i2cx_power_control(AE350_POWER_STATE state, I2C_RESOURCES* i2c)
 
 			if (i2c->dma_tx && (i2c->info->Status.busy != 0))
 			{
-				dma_channel_disable(i2c->dma_tx->channel);
+				dma_channel_disable(i2c->info->dma_tx_ch);
 			}
 
 			if (i2c->dma_rx && (i2c->info->Status.busy != 0))
 			{
-				dma_channel_disable(i2c->dma_rx->channel);
+				dma_channel_disable(i2c->info->dma_rx_ch);
 			}
 		}
 
@@ -424,24 +482,23 @@ int32_t i2cx_master_transmit(uint32_t addr, const uint8_t* data, uint32_t num, b
 	if (i2c->dma_tx)
 	{
 		// Configure DMA channel
-		stat = dma_channel_configure(i2c->dma_tx->channel,
-		                             (uint32_t)(long)(&i2c->info->middleware_tx_buf[0]),
-		                             (uint32_t)(long)(&(i2c->reg->DATA)),
-		                             num,
-		                             DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
- 		                             DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
- 		                             DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-		                             DMA_CH_CTRL_DMODE_HANDSHAKE |
-		                             DMA_CH_CTRL_SRCADDR_INC |
-		                             DMA_CH_CTRL_DSTADDR_FIX |
-		                             DMA_CH_CTRL_DSTREQ(i2c->dma_tx->reqsel) |
-		                             DMA_CH_CTRL_INTABT |
-		                             DMA_CH_CTRL_INTERR |
-		                             DMA_CH_CTRL_INTTC |
-		                             DMA_CH_CTRL_ENABLE,
-		                             i2c->dma_tx->cb_event);
+		stat = dma_channel_configure_auto(i2c->info->dma_tx_ch,
+		                                  i2c->info->dma_tx_desc,
+		                                  DMA_XFER_DESC,
+		                                  (uint32_t)(long)(&i2c->info->middleware_tx_buf[0]),
+		                                  (uint32_t)(long)(&(i2c->reg->DATA)),
+		                                  num,
+		                                  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_DMODE_HANDSHAKE |
+		                                  DMA_CH_CTRL_SRCADDR_INC |
+		                                  DMA_CH_CTRL_DSTADDR_FIX |
+		                                  DMA_CH_CTRL_DSTREQ(i2c->dma_tx->reqsel) |
+		                                  DMA_CH_CTRL_INTABT |
+		                                  DMA_CH_CTRL_INTERR |
+		                                  DMA_CH_CTRL_INTTC |
+		                                  DMA_CH_CTRL_ENABLE,
+		                                  i2c->dma_tx->cb_event);
 
 		if (stat == -1)
 		{
@@ -573,24 +630,23 @@ int32_t i2cx_master_receive(uint32_t addr, uint8_t* data, uint32_t num, bool xfe
 	if (i2c->dma_rx)
 	{
 		// Configure DMA channel
-		stat = dma_channel_configure(i2c->dma_rx->channel,
-		                             (uint32_t)(long)(&(i2c->reg->DATA)),
-		                             (uint32_t)(long)(&i2c->info->middleware_rx_buf[0]),
-		                             num,
-		                             DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-		                             DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
-		                             DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-		                             DMA_CH_CTRL_SMODE_HANDSHAKE |
-		                             DMA_CH_CTRL_SRCADDR_FIX |
-		                             DMA_CH_CTRL_DSTADDR_INC |
-		                             DMA_CH_CTRL_SRCREQ(i2c->dma_rx->reqsel) |
-		                             DMA_CH_CTRL_INTABT |
-		                             DMA_CH_CTRL_INTERR |
-		                             DMA_CH_CTRL_INTTC |
-		                             DMA_CH_CTRL_ENABLE,
-		                             i2c->dma_rx->cb_event);
+		stat = dma_channel_configure_auto(i2c->info->dma_rx_ch,
+		                                  i2c->info->dma_rx_desc,
+		                                  DMA_XFER_DESC,
+		                                  (uint32_t)(long)(&(i2c->reg->DATA)),
+		                                  (uint32_t)(long)(&i2c->info->middleware_rx_buf[0]),
+		                                  num,
+		                                  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_SMODE_HANDSHAKE |
+		                                  DMA_CH_CTRL_SRCADDR_FIX |
+		                                  DMA_CH_CTRL_DSTADDR_INC |
+		                                  DMA_CH_CTRL_SRCREQ(i2c->dma_rx->reqsel) |
+		                                  DMA_CH_CTRL_INTABT |
+		                                  DMA_CH_CTRL_INTERR |
+		                                  DMA_CH_CTRL_INTTC |
+		                                  DMA_CH_CTRL_ENABLE,
+		                                  i2c->dma_rx->cb_event);
 
 		if (stat == -1)
 		{
@@ -849,8 +905,8 @@ void i2c_cmpl_handler(I2C_RESOURCES* i2c)
 		{
 			if (i2c->dma_tx)
 			{
-				i2c->info->Xfered_Data_Wt_Ptr = dma_channel_get_count(DRV_I2C_DMA_TX_CH);
-				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(DRV_I2C_DMA_TX_CH);
+				i2c->info->Xfered_Data_Wt_Ptr = dma_channel_get_count(i2c->info->dma_tx_ch);
+				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(i2c->info->dma_tx_ch);
 			}
 			else
 			{
@@ -868,8 +924,8 @@ void i2c_cmpl_handler(I2C_RESOURCES* i2c)
 		{
 			if (i2c->dma_rx)
 			{
-				i2c->info->Xfered_Data_Rd_Ptr = dma_channel_get_count(DRV_I2C_DMA_RX_CH);
-				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(DRV_I2C_DMA_RX_CH);
+				i2c->info->Xfered_Data_Rd_Ptr = dma_channel_get_count(i2c->info->dma_rx_ch);
+				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(i2c->info->dma_rx_ch);
 
 				// Clear and set driver state to master RX complete
 				i2c->info->Driver_State = I2C_DRV_MASTER_RX_CMPL;
@@ -951,8 +1007,8 @@ void i2c_cmpl_handler(I2C_RESOURCES* i2c)
 				i2c->reg->INTEN = Tmp_C;
 
 		        // Key point for middle ware to query
-				i2c->info->Xfered_Data_Wt_Ptr = dma_channel_get_count(DRV_I2C_DMA_TX_CH);
-				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(DRV_I2C_DMA_TX_CH);
+				i2c->info->Xfered_Data_Wt_Ptr = dma_channel_get_count(i2c->info->dma_tx_ch);
+				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(i2c->info->dma_tx_ch);
 
 				// Clear and set driver state to slave TX complete
 				i2c->info->Driver_State = I2C_DRV_SLAVE_TX_CMPL;
@@ -964,10 +1020,10 @@ void i2c_cmpl_handler(I2C_RESOURCES* i2c)
 			if (i2c->info->Driver_State & I2C_DRV_SLAVE_RX)
 			{
 				// Key point for middle ware to query
-				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(DRV_I2C_DMA_RX_CH);
+				i2c->info->Xfer_Cmpl_Count = dma_channel_get_count(i2c->info->dma_rx_ch);
 
 				// Abort DMA channel since MAX_XFER_SZ-read and expect complete in cmpl_handler
-				dma_channel_abort(DRV_I2C_DMA_RX_CH);
+				dma_channel_abort(i2c->info->dma_rx_ch);
 
 				check = (Tmp_S & CTRL_DATA_COUNT);
 				// Clear and set driver state to slave RX complete
@@ -1046,24 +1102,23 @@ void i2cx_slave_fifo_write(I2C_RESOURCES* i2c)
 		i2c->reg->CTRL = Tmp_C;
 
 		// Configure DMA channel
-		stat = dma_channel_configure(i2c->dma_tx->channel,
-		                             (uint32_t)(long)(&i2c->info->middleware_tx_buf[0]),
-		                             (uint32_t)(long)(&(i2c->reg->DATA)),
-		                             write_fifo_count,
-		                             DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-		                             DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-		                             DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
-		                             DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-		                             DMA_CH_CTRL_DMODE_HANDSHAKE |
-		                             DMA_CH_CTRL_SRCADDR_INC |
-		                             DMA_CH_CTRL_DSTADDR_FIX |
-		                             DMA_CH_CTRL_DSTREQ(i2c->dma_tx->reqsel) |
-		                             DMA_CH_CTRL_INTABT |
-		                             DMA_CH_CTRL_INTERR |
-		                             DMA_CH_CTRL_INTTC |
-		                             DMA_CH_CTRL_ENABLE,
-		                             i2c->dma_tx->cb_event);
+		stat = dma_channel_configure_auto(i2c->info->dma_tx_ch,
+		                                  i2c->info->dma_tx_desc,
+		                                  DMA_XFER_DESC,
+		                                  (uint32_t)(long)(&i2c->info->middleware_tx_buf[0]),
+		                                  (uint32_t)(long)(&(i2c->reg->DATA)),
+		                                  write_fifo_count,
+		                                  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+		                                  DMA_CH_CTRL_DMODE_HANDSHAKE |
+		                                  DMA_CH_CTRL_SRCADDR_INC |
+		                                  DMA_CH_CTRL_DSTADDR_FIX |
+		                                  DMA_CH_CTRL_DSTREQ(i2c->dma_tx->reqsel) |
+		                                  DMA_CH_CTRL_INTABT |
+		                                  DMA_CH_CTRL_INTERR |
+		                                  DMA_CH_CTRL_INTTC |
+		                                  DMA_CH_CTRL_ENABLE,
+		                                  i2c->dma_tx->cb_event);
 
 		if (stat == -1)
 		{
@@ -1238,24 +1293,23 @@ void i2cx_slave_addr_hit_handler(I2C_RESOURCES* i2c)
 			i2c->reg->CTRL = Tmp_C;
 
 			// Configure DMA channel w/ MAX_XFER_SZ-read and expect complete in cmpl_handler
-			stat = dma_channel_configure(i2c->dma_rx->channel,
-			                             (uint32_t)(long)(&(i2c->reg->DATA)),
-			                             (uint32_t)(long)(&i2c->info->Xfer_Data_Rd_Buf[i2c->info->Xfered_Data_Rd_Ptr]),
-			                             MAX_XFER_SZ,
-			                             DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-			                             DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-			                             DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-			                             DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
-			                             DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-			                             DMA_CH_CTRL_SMODE_HANDSHAKE |
-			                             DMA_CH_CTRL_SRCADDR_FIX |
-			                             DMA_CH_CTRL_DSTADDR_INC |
-			                             DMA_CH_CTRL_SRCREQ(i2c->dma_rx->reqsel) |
-			                             DMA_CH_CTRL_INTABT |
-			                             DMA_CH_CTRL_INTERR |
-			                             DMA_CH_CTRL_INTTC |
-			                             DMA_CH_CTRL_ENABLE,
-			                             i2c->dma_rx->cb_event);
+			stat = dma_channel_configure_auto(i2c->info->dma_rx_ch,
+			                                  i2c->info->dma_rx_desc,
+			                                  DMA_XFER_DESC,
+			                                  (uint32_t)(long)(&(i2c->reg->DATA)),
+			                                  (uint32_t)(long)(&i2c->info->Xfer_Data_Rd_Buf[i2c->info->Xfered_Data_Rd_Ptr]),
+			                                  MAX_XFER_SZ,
+			                                  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+			                                  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+			                                  DMA_CH_CTRL_SMODE_HANDSHAKE |
+			                                  DMA_CH_CTRL_SRCADDR_FIX |
+			                                  DMA_CH_CTRL_DSTADDR_INC |
+			                                  DMA_CH_CTRL_SRCREQ(i2c->dma_rx->reqsel) |
+			                                  DMA_CH_CTRL_INTABT |
+			                                  DMA_CH_CTRL_INTERR |
+			                                  DMA_CH_CTRL_INTTC |
+			                                  DMA_CH_CTRL_ENABLE,
+			                                  i2c->dma_rx->cb_event);
 
 			if (stat == -1)
 			{
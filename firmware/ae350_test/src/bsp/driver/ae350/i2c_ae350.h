@@ -298,12 +298,17 @@ typedef struct _I2C_INFO
 	uint32_t                        Slave_Rx_Cmpl_Ctrl_Reg_Val;
 	volatile AE350_I2C_STATUS       Status;
 	uint32_t                        Xfer_Cmpl_Count;
+	// DMA channels of dma_channel_request()
+	uint8_t                         dma_tx_ch;
+	uint8_t                         dma_rx_ch;
+	DMA_LLP_DESC                    dma_tx_desc[DMA_XFER_DESC];	// DMA TX chain of the alignment
+	DMA_LLP_DESC                    dma_rx_desc[DMA_XFER_DESC];	// DMA RX chain of the alignment
 } I2C_INFO;
 
 // I2C DMA
 typedef const struct _I2C_DMA
 {
-	uint8_t                 channel;          // DMA Channel
+	uint8_t                 channel;          // Preferred DMA Channel
 	uint8_t                 reqsel;           // DMA request selection
 	DMA_SignalEvent_t       cb_event;         // DMA Event callback
 } I2C_DMA;
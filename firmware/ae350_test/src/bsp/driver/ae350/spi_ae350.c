@@ -152,6 +152,12 @@ static int32_t spix_power_control(AE350_POWER_STATE state, SPI_RESOURCES *spi)
 	switch (state)
 	{
 		case AE350_POWER_OFF:
+			// The DMA channels may belong to another driver when not powered
+			if ((spi->info->flags & SPI_FLAG_POWERED) == 0U)
+			{
+				return AE350_DRIVER_OK;
+			}
+
 			// Disable PLIC interrupt SPI0 source
 			__nds__plic_disable_interrupt(spi->irq_num);
 
@@ -162,13 +168,26 @@ static int32_t spix_power_control(AE350_POWER_STATE state, SPI_RESOURCES *spi)
 
 				if (spi->dma_tx && (spi->info->status.busy != 0))
 				{
-					dma_channel_disable(spi->dma_tx->channel);
+					dma_channel_disable(spi->info->dma_tx_ch);
 				}
 
 				if (spi->dma_rx && (spi->info->status.busy != 0))
 				{
-					dma_channel_disable(spi->dma_rx->channel);
+					dma_channel_disable(spi->info->dma_rx_ch);
 				}
+
+				if (spi->dma_tx)
+				{
+					dma_channel_release(spi->info->dma_tx_ch);
+				}
+
+				if (spi->dma_rx)
+				{
+					dma_channel_release(spi->info->dma_rx_ch);
+				}
+
+				spi->info->dma_tx_ch = DMA_CHANNEL_ANY;
+				spi->info->dma_rx_ch = DMA_CHANNEL_ANY;
 			}
 
 			// Reset SPI and TX/RX FIFOs
@@ -204,10 +223,42 @@ static int32_t spix_power_control(AE350_POWER_STATE state, SPI_RESOURCES *spi)
 				return AE350_DRIVER_OK;
 			}
 
-			// DMA initialize
+			// DMA initialize, the channels are owned until power off
 			if (spi->dma_tx || spi->dma_rx)
 			{
+				int32_t tx_ch = 0, rx_ch = 0;
+
 				dma_initialize();
+
+				if (spi->dma_tx)
+				{
+					tx_ch = dma_channel_request(spi->dma_tx->channel, DMA_PRIO_NORMAL);
+				}
+
+				if (spi->dma_rx)
+				{
+					rx_ch = dma_channel_request(spi->dma_rx->channel, DMA_PRIO_HIGH);
+				}
+
+				if ((tx_ch == -1) || (rx_ch == -1))
+				{
+					if (spi->dma_tx && (tx_ch != -1))
+					{
+						dma_channel_release(tx_ch);
+					}
+
+					if (spi->dma_rx && (rx_ch != -1))
+					{
+						dma_channel_release(rx_ch);
+					}
+
+					dma_uninitialize();
+
+					return AE350_DRIVER_ERROR_BUSY;
+				}
+
+				spi->info->dma_tx_ch = tx_ch;
+				spi->info->dma_rx_ch = rx_ch;
 			}
 
 			// Reset SPI and TX/RX FIFOs
@@ -248,6 +299,25 @@ static int32_t spix_power_control(AE350_POWER_STATE state, SPI_RESOURCES *spi)
 	return AE350_DRIVER_OK;
 }
 
+// Describe the DATA FIFO of the data bits to the DMA, TX moves up to the refill room of a request
+static void spix_dma_fifo_set(SPI_RESOURCES *spi)
+{
+	uint8_t width = spi->info->src_width >> 1;	// DMA_WIDTH_* of 1, 2 or 4 bytes
+	uint8_t bsize;
+
+	for (bsize = DMA_BSIZE_1; (bsize < DMA_BSIZE_16) && ((2U << bsize) <= (uint32_t)(spi->info->txfifo_size - 2)); bsize++);
+
+	if (spi->dma_tx)
+	{
+		dma_fifo_set(spi->dma_tx->reqsel, width, bsize);
+	}
+
+	if (spi->dma_rx)
+	{
+		dma_fifo_set(spi->dma_rx->reqsel, width, DMA_BSIZE_1);
+	}
+}
+
 // Send data
 static int32_t spix_send(const void *data, uint32_t num, SPI_RESOURCES *spi)
 {
@@ -323,29 +393,29 @@ static int32_t spix_send(const void *data, uint32_t num, SPI_RESOURCES *spi)
 	// DMA mode
 	if (spi->dma_tx)
 	{
+		spix_dma_fifo_set(spi);
+
 		// Enable TX DMA
 		spi->reg->CTRL |= TXDMAEN;
 
 		// Configure DMA channel
-		stat = dma_channel_configure(spi->dma_tx->channel,
-					     (uint32_t)(long)spi->info->xfer.tx_buf,
-					     (uint32_t)(long)(&(spi->reg->DATA)),
-					     num,
-					     DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-					     DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-					     DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-					     // DMA width setting: 1 byte:0x0, 2 byte:0x1, 4 byte:0x2
-					     DMA_CH_CTRL_SWIDTH(spi->info->src_width/2) |
-					     DMA_CH_CTRL_DWIDTH(spi->info->src_width/2) |
-					     DMA_CH_CTRL_DMODE_HANDSHAKE |
-					     DMA_CH_CTRL_SRCADDR_INC |
-					     DMA_CH_CTRL_DSTADDR_FIX |
-					     DMA_CH_CTRL_DSTREQ(spi->dma_tx->reqsel) |
-					     DMA_CH_CTRL_INTABT |
-					     DMA_CH_CTRL_INTERR |
-					     DMA_CH_CTRL_INTTC |
-					     DMA_CH_CTRL_ENABLE,
-					     spi->dma_tx->cb_event);
+		stat = dma_channel_configure_auto(spi->info->dma_tx_ch,
+					          spi->info->dma_tx_desc,
+					          DMA_XFER_DESC,
+					          (uint32_t)(long)spi->info->xfer.tx_buf,
+					          (uint32_t)(long)(&(spi->reg->DATA)),
+					          num * spi->info->src_width,
+					          DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+					          DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+					          DMA_CH_CTRL_DMODE_HANDSHAKE |
+					          DMA_CH_CTRL_SRCADDR_INC |
+					          DMA_CH_CTRL_DSTADDR_FIX |
+					          DMA_CH_CTRL_DSTREQ(spi->dma_tx->reqsel) |
+					          DMA_CH_CTRL_INTABT |
+					          DMA_CH_CTRL_INTERR |
+					          DMA_CH_CTRL_INTTC |
+					          DMA_CH_CTRL_ENABLE,
+					          spi->dma_tx->cb_event);
 
 		if (stat == -1)
 		{
@@ -447,29 +517,29 @@ static int32_t spix_receive(void *data, uint32_t num, SPI_RESOURCES *spi)
 	// DMA mode
 	if (spi->dma_rx)
 	{
+		spix_dma_fifo_set(spi);
+
 		// Enable RX DMA
 		spi->reg->CTRL |= RXDMAEN;
 
 		// Configure DMA channel
-		stat = dma_channel_configure(spi->dma_rx->channel,
-					     (uint32_t)(long)(&(spi->reg->DATA)),
-					     (uint32_t)(long)spi->info->xfer.rx_buf,
-					     num,
-					     DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-					     DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-					     DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-					     // DMA width setting: 1 byte:0x0, 2 byte:0x1, 4 byte:0x2
-					     DMA_CH_CTRL_SWIDTH(spi->info->src_width/2) |
-					     DMA_CH_CTRL_DWIDTH(spi->info->src_width/2) |
-					     DMA_CH_CTRL_SMODE_HANDSHAKE |
-					     DMA_CH_CTRL_SRCADDR_FIX |
-					     DMA_CH_CTRL_DSTADDR_INC |
-					     DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
-					     DMA_CH_CTRL_INTABT |
-					     DMA_CH_CTRL_INTERR |
-					     DMA_CH_CTRL_INTTC |
-					     DMA_CH_CTRL_ENABLE,
-					     spi->dma_rx->cb_event);
+		stat = dma_channel_configure_auto(spi->info->dma_rx_ch,
+					          spi->info->dma_rx_desc,
+					          DMA_XFER_DESC,
+					          (uint32_t)(long)(&(spi->reg->DATA)),
+					          (uint32_t)(long)spi->info->xfer.rx_buf,
+					          num * spi->info->src_width,
+					          DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+					          DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+					          DMA_CH_CTRL_SMODE_HANDSHAKE |
+					          DMA_CH_CTRL_SRCADDR_FIX |
+					          DMA_CH_CTRL_DSTADDR_INC |
+					          DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
+					          DMA_CH_CTRL_INTABT |
+					          DMA_CH_CTRL_INTERR |
+					          DMA_CH_CTRL_INTTC |
+					          DMA_CH_CTRL_ENABLE,
+					          spi->dma_rx->cb_event);
 
 		if (stat == -1)
 		{
@@ -600,31 +670,31 @@ static int32_t spix_transfer(const void *data_out, void *data_in, uint32_t num,
 	// DMA mode
 	if (spi->dma_tx || spi->dma_rx)
 	{
+		spix_dma_fifo_set(spi);
+
 		if (spi->dma_tx)
 		{
 			// Enable TX DMA
 			spi->reg->CTRL |= TXDMAEN;
 
 			// Configure DMA channel
-			stat = dma_channel_configure(spi->dma_tx->channel,
-						      (uint32_t)(long)spi->info->xfer.tx_buf,
-						      (uint32_t)(long)(&(spi->reg->DATA)),
-						      num,
-						      DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-						      DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-						      DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-						      // DMA width setting: 1 byte:0x0, 2 byte:0x1, 4 byte:0x2
-						      DMA_CH_CTRL_SWIDTH(spi->info->src_width/2) |
-						      DMA_CH_CTRL_DWIDTH(spi->info->src_width/2) |
-						      DMA_CH_CTRL_DMODE_HANDSHAKE |
-						      DMA_CH_CTRL_SRCADDR_INC |
-						      DMA_CH_CTRL_DSTADDR_FIX |
-						      DMA_CH_CTRL_DSTREQ(spi->dma_tx->reqsel) |
-						      DMA_CH_CTRL_INTABT |
-						      DMA_CH_CTRL_INTERR |
-						      DMA_CH_CTRL_INTTC |
-						      DMA_CH_CTRL_ENABLE,
-						      spi->dma_tx->cb_event);
+			stat = dma_channel_configure_auto(spi->info->dma_tx_ch,
+						           spi->info->dma_tx_desc,
+						           DMA_XFER_DESC,
+						           (uint32_t)(long)spi->info->xfer.tx_buf,
+						           (uint32_t)(long)(&(spi->reg->DATA)),
+						           num * spi->info->src_width,
+						           DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+						           DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+						           DMA_CH_CTRL_DMODE_HANDSHAKE |
+						           DMA_CH_CTRL_SRCADDR_INC |
+						           DMA_CH_CTRL_DSTADDR_FIX |
+						           DMA_CH_CTRL_DSTREQ(spi->dma_tx->reqsel) |
+						           DMA_CH_CTRL_INTABT |
+						           DMA_CH_CTRL_INTERR |
+						           DMA_CH_CTRL_INTTC |
+						           DMA_CH_CTRL_ENABLE,
+						           spi->dma_tx->cb_event);
 			if (stat == -1)
 			{
 				return AE350_DRIVER_ERROR;
@@ -637,25 +707,23 @@ static int32_t spix_transfer(const void *data_out, void *data_in, uint32_t num,
 			spi->reg->CTRL |= RXDMAEN;
 
 			// Configure DMA channel
-			stat = dma_channel_configure(spi->dma_rx->channel,
-						     (uint32_t)(long)(&(spi->reg->DATA)),
-						     (uint32_t)(long)spi->info->xfer.rx_buf,
-						     dma_rx_num,
-						     DMA_CH_CTRL_SBINF(DMA_INF_IDX0) |
-						     DMA_CH_CTRL_DBINF(DMA_INF_IDX0) |
-						     DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-						     // DMA width setting: 1 byte:0x0, 2 byte:0x1, 4 byte:0x2
-						     DMA_CH_CTRL_SWIDTH(spi->info->src_width/2) |
-						     DMA_CH_CTRL_DWIDTH(spi->info->src_width/2) |
-						     DMA_CH_CTRL_SMODE_HANDSHAKE |
-						     DMA_CH_CTRL_SRCADDR_FIX |
-						     DMA_CH_CTRL_DSTADDR_INC |
-						     DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
-						     DMA_CH_CTRL_INTABT |
-						     DMA_CH_CTRL_INTERR |
-						     DMA_CH_CTRL_INTTC |
-						     DMA_CH_CTRL_ENABLE,
-						     spi->dma_rx->cb_event);
+			stat = dma_channel_configure_auto(spi->info->dma_rx_ch,
+						          spi->info->dma_rx_desc,
+						          DMA_XFER_DESC,
+						          (uint32_t)(long)(&(spi->reg->DATA)),
+						          (uint32_t)(long)spi->info->xfer.rx_buf,
+						          dma_rx_num * spi->info->src_width,
+						          DMA_CH_CTRL_SBINF(DMA_INF_IDX0) |
+						          DMA_CH_CTRL_DBINF(DMA_INF_IDX0) |
+						          DMA_CH_CTRL_SMODE_HANDSHAKE |
+						          DMA_CH_CTRL_SRCADDR_FIX |
+						          DMA_CH_CTRL_DSTADDR_INC |
+						          DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
+						          DMA_CH_CTRL_INTABT |
+						          DMA_CH_CTRL_INTERR |
+						          DMA_CH_CTRL_INTTC |
+						          DMA_CH_CTRL_ENABLE,
+						          spi->dma_rx->cb_event);
 			if (stat == -1)
 			{
 				return AE350_DRIVER_ERROR;
@@ -702,7 +770,7 @@ static int32_t spix_get_data_count(SPI_RESOURCES *spi)
 		case SPI_TRANSFER:
 			if (spi->dma_tx)
 			{
-				return (dma_channel_get_count(spi->dma_tx->channel));
+				return (dma_channel_get_count(spi->info->dma_tx_ch) / spi->info->src_width);
 			}
 			else
 			{
@@ -711,7 +779,7 @@ static int32_t spix_get_data_count(SPI_RESOURCES *spi)
 		case SPI_RECEIVE:
 			if (spi->dma_rx)
 			{
-				return (dma_channel_get_count(spi->dma_rx->channel));
+				return (dma_channel_get_count(spi->info->dma_rx_ch) / spi->info->src_width);
 			}
 			else
 			{
@@ -1053,7 +1121,7 @@ static void spix_irq_handler(SPI_RESOURCES *spi)
 		{
 			if (!spi->info->xfer.dma_tx_complete)
 			{
-				dma_channel_disable(spi->dma_tx->channel);
+				dma_channel_disable(spi->info->dma_tx_ch);
 			}
 
 			spi->info->xfer.dma_tx_complete = 0;
@@ -1063,7 +1131,7 @@ static void spix_irq_handler(SPI_RESOURCES *spi)
 		{
 			if (!spi->info->xfer.dma_rx_complete)
 			{
-				dma_channel_disable(spi->dma_rx->channel);
+				dma_channel_disable(spi->info->dma_rx_ch);
 			}
 
 			spi->info->xfer.dma_rx_complete = 0;
@@ -1119,25 +1187,23 @@ static void spix_dma_rx_event (uint32_t event, SPI_RESOURCES * spi)
 			{
 				// Setting another DMA transfer to cover the dummy data from slave when master is sending header.
 				// Configure DMA channel
-				dma_channel_configure(spi->dma_rx->channel,
-						       (uint32_t)(long)(&(spi->reg->DATA)),
-						       (uint32_t)(long)spi->info->xfer.rx_buf,
-						       spi->info->data_num,
-						       DMA_CH_CTRL_SBINF(DMA_INF_IDX0) |
-						       DMA_CH_CTRL_DBINF(DMA_INF_IDX0) |
-						       DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-						       // DMA width setting: 1 byte:0x0, 2 byte:0x1, 4 byte:0x2
-						       DMA_CH_CTRL_SWIDTH(spi->info->src_width/2) |
-						       DMA_CH_CTRL_DWIDTH(spi->info->src_width/2) |
-						       DMA_CH_CTRL_SMODE_HANDSHAKE |
-						       DMA_CH_CTRL_SRCADDR_FIX |
-						       DMA_CH_CTRL_DSTADDR_INC |
-						       DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
-						       DMA_CH_CTRL_INTABT |
-						       DMA_CH_CTRL_INTERR |
-						       DMA_CH_CTRL_INTTC |
-						       DMA_CH_CTRL_ENABLE,
-						       spi->dma_rx->cb_event);
+				dma_channel_configure_auto(spi->info->dma_rx_ch,
+						            spi->info->dma_rx_desc,
+						            DMA_XFER_DESC,
+						            (uint32_t)(long)(&(spi->reg->DATA)),
+						            (uint32_t)(long)spi->info->xfer.rx_buf,
+						            spi->info->data_num * spi->info->src_width,
+						            DMA_CH_CTRL_SBINF(DMA_INF_IDX0) |
+						            DMA_CH_CTRL_DBINF(DMA_INF_IDX0) |
+						            DMA_CH_CTRL_SMODE_HANDSHAKE |
+						            DMA_CH_CTRL_SRCADDR_FIX |
+						            DMA_CH_CTRL_DSTADDR_INC |
+						            DMA_CH_CTRL_SRCREQ(spi->dma_rx->reqsel) |
+						            DMA_CH_CTRL_INTABT |
+						            DMA_CH_CTRL_INTERR |
+						            DMA_CH_CTRL_INTTC |
+						            DMA_CH_CTRL_ENABLE,
+						            spi->dma_rx->cb_event);
 				spi->info->is_header = 0;
 			}
 
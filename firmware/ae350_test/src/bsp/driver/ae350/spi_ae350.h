@@ -132,12 +132,16 @@ typedef struct _SPI_INFO
 	uint8_t					src_width;     // SPI transfer width(align 8 bits)
 	uint32_t                data_num;      // Number of the pure transfer data(Does not include header)
 	uint8_t					tx_header_len; // SPI header(Usually include CMD, ADDRESS and DUMMY)
+	uint8_t					dma_tx_ch;     // DMA TX channel of dma_channel_request()
+	uint8_t					dma_rx_ch;     // DMA RX channel of dma_channel_request()
+	DMA_LLP_DESC			dma_tx_desc[DMA_XFER_DESC];	// DMA TX chain of the alignment
+	DMA_LLP_DESC			dma_rx_desc[DMA_XFER_DESC];	// DMA RX chain of the alignment
 } SPI_INFO;
 
 // SPI DMA
 typedef const struct _SPI_DMA
 {
-	uint8_t				channel;     	// DMA channel
+	uint8_t				channel;     	// Preferred DMA channel
 	uint8_t				reqsel;      	// DMA request selection
 	DMA_SignalEvent_t	cb_event;   	// DMA event callback
 } SPI_DMA;
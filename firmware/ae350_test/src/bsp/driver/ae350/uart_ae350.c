@@ -10,6 +10,11 @@
 // Includes ---------------------------------------------------------------------------------
 #include "uart_ae350.h"
 
+// If enable L1 cache
+#ifdef CFG_CACHE_ENABLE
+#include "cache.h"
+#endif
+
 
 // Variables  -------------------------------------------------------------------------------
 
@@ -242,6 +247,146 @@ static uint32_t uart_rxline_irq_handler (UART_RESOURCES *uartx)
 	return event;
 }
 
+/*****************************************************************************************
+  \fn          uint32_t uart_rx_advance (UART_RESOURCES *uartx, uint32_t num)
+  \brief       Account data of a continuous receive, the write index wraps at the end
+               of the buffer
+  \param[in]   uartx     Pointer to UART resources
+  \param[in]   num       Number of data written at the write index
+  \return      AE350_UART_EVENT_RECEIVE_COMPLETE when a half of the buffer is filled
+******************************************************************************************/
+static uint32_t uart_rx_advance (UART_RESOURCES *uartx, uint32_t num)
+{
+	uint32_t event = 0U;
+
+	uartx->info->xfer.rx_cnt += num;
+	uartx->info->xfer.rx_pos += num;
+
+	if ((uartx->info->xfer.rx_pos == (uartx->info->xfer.rx_num >> 1)) ||
+		(uartx->info->xfer.rx_pos == uartx->info->xfer.rx_num))
+	{
+		event = AE350_UART_EVENT_RECEIVE_COMPLETE;
+	}
+
+	if (uartx->info->xfer.rx_pos == uartx->info->xfer.rx_num)
+	{
+		uartx->info->xfer.rx_pos = 0U;
+	}
+
+	return event;
+}
+
+/*****************************************************************************************
+  \fn          int32_t uart_rx_dma_next (UART_RESOURCES *uartx)
+  \brief       Start the DMA segment of a continuous receive at the write index.
+               A segment ends at the half or at the end of the buffer. Bursts of 8
+               leave the tail of a packet in the RX FIFO for the character time-out,
+               a write index off the burst size is first aligned with single bytes.
+  \param[in]   uartx     Pointer to UART resources
+  \return      \ref execution_status
+******************************************************************************************/
+static int32_t uart_rx_dma_next (UART_RESOURCES *uartx)
+{
+	uint32_t pos, end, bsize;
+
+	pos = uartx->info->xfer.rx_pos;
+	end = (pos < (uartx->info->xfer.rx_num >> 1)) ? (uartx->info->xfer.rx_num >> 1) : uartx->info->xfer.rx_num;
+
+	if (pos & 7U)
+	{
+		uartx->info->xfer.rx_seg = 8U - (pos & 7U);
+		bsize = DMA_BSIZE_1;
+	}
+	else
+	{
+		uartx->info->xfer.rx_seg = end - pos;
+		bsize = DMA_BSIZE_8;
+	}
+
+	if (dma_channel_configure (uartx->info->dma_rx_ch,
+							   (uint32_t)(long)&uartx->reg->RBR,
+							   (uint32_t)(long)(uartx->info->xfer.rx_buf + pos),
+							   uartx->info->xfer.rx_seg,
+							   DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+							   DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+							   DMA_CH_CTRL_SBSIZE(bsize) |
+							   DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
+							   DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
+							   DMA_CH_CTRL_SMODE_HANDSHAKE |
+							   DMA_CH_CTRL_SRCADDR_FIX |
+							   DMA_CH_CTRL_DSTADDR_INC |
+							   DMA_CH_CTRL_SRCREQ(uartx->dma_rx->reqsel) |
+							   DMA_CH_CTRL_INTABT |
+							   DMA_CH_CTRL_INTERR |
+							   DMA_CH_CTRL_INTTC |
+							   DMA_CH_CTRL_ENABLE,
+							   uartx->dma_rx->cb_event) == -1)
+	{
+		return AE350_DRIVER_ERROR;
+	}
+
+	return AE350_DRIVER_OK;
+}
+
+/*****************************************************************************************
+  \fn          uint32_t uart_rx_dma_timeout (UART_RESOURCES *uartx)
+  \brief       End of a packet in continuous DMA receive. The DMA segment is stopped,
+               the tail of the packet is read from the RX FIFO and a new segment is
+               started at the write index.
+  \param[in]   uartx     Pointer to UART resources
+  \return      Receive event mask
+******************************************************************************************/
+static uint32_t uart_rx_dma_timeout (UART_RESOURCES *uartx)
+{
+	uint32_t event, cnt, pos, i;
+	unsigned long saved_mie;
+
+	// The DMA interrupt of a segment that just completed must not run in between
+	saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	dma_channel_disable (uartx->info->dma_rx_ch);
+	cnt = dma_channel_get_count (uartx->info->dma_rx_ch);
+
+	// Also clears a pending terminal count, the segment is accounted here
+	dma_channel_abort (uartx->info->dma_rx_ch);
+
+	event = uart_rx_advance (uartx, cnt);
+
+	// Read the tail of the packet
+	pos = uartx->info->xfer.rx_pos;
+	for (i = 16U; (i != 0U) && (uartx->reg->LSR & UARTC_LSR_RDR); i--)
+	{
+		uartx->info->xfer.rx_buf[uartx->info->xfer.rx_pos] = uartx->reg->RBR;
+		event |= uart_rx_advance (uartx, 1U);
+	}
+
+#ifdef CFG_CACHE_ENABLE
+	// The next segment invalidates the cache lines it shares with the tail, none in a local or non-cacheable buffer
+	if ((uartx->info->xfer.rx_pos != pos) &&
+		ae350_dma_need_writeback((unsigned long)uartx->info->xfer.rx_buf, uartx->info->xfer.rx_num))
+	{
+		if (uartx->info->xfer.rx_pos < pos)
+		{
+			ae350_dcache_writeback_range((unsigned long)(uartx->info->xfer.rx_buf + pos), uartx->info->xfer.rx_num - pos);
+			ae350_dcache_writeback_range((unsigned long)uartx->info->xfer.rx_buf, uartx->info->xfer.rx_pos);
+		}
+		else
+		{
+			ae350_dcache_writeback_range((unsigned long)(uartx->info->xfer.rx_buf + pos), uartx->info->xfer.rx_pos - pos);
+		}
+	}
+#endif
+
+	if (uart_rx_dma_next (uartx) != AE350_DRIVER_OK)
+	{
+		uartx->info->rx_status.rx_busy = 0U;
+	}
+
+	set_csr(NDS_MSTATUS, saved_mie);
+
+	return event;
+}
+
 // Function Prototypes
 static int32_t uart_receive (void *data, uint32_t num, UART_RESOURCES *uartx);
 
@@ -297,10 +442,55 @@ static int32_t uart_initialize (AE350_UART_SignalEvent_t cb_event, UART_RESOURCE
 	uartx->info->xfer.send_active           = 0U;
 	uartx->info->xfer.tx_def_val            = 0U;
 
-	// DMA Initialize
+	// DMA Initialize, the channels are owned until uninitialize
 	if (uartx->dma_tx || uartx->dma_rx)
 	{
+		int32_t tx_ch = 0, rx_ch = 0;
+
 		dma_initialize ();
+
+		if (uartx->dma_tx)
+		{
+			tx_ch = dma_channel_request (uartx->dma_tx->channel, DMA_PRIO_NORMAL);
+		}
+
+		// The RX FIFO overruns when the receive waits, the send can wait
+		if (uartx->dma_rx)
+		{
+			rx_ch = dma_channel_request (uartx->dma_rx->channel, DMA_PRIO_HIGH);
+		}
+
+		if ((tx_ch == -1) || (rx_ch == -1))
+		{
+			if (uartx->dma_tx && (tx_ch != -1))
+			{
+				dma_channel_release (tx_ch);
+			}
+
+			if (uartx->dma_rx && (rx_ch != -1))
+			{
+				dma_channel_release (rx_ch);
+			}
+
+			dma_uninitialize ();
+
+			return AE350_DRIVER_ERROR_BUSY;
+		}
+
+		uartx->info->dma_tx_ch = tx_ch;
+		uartx->info->dma_rx_ch = rx_ch;
+
+		// The TX request comes at the trigger level of 1 character, 8 always fit the 16 byte FIFO.
+		// The RX request comes at the RX trigger level or at the time-out, single characters.
+		if (uartx->dma_tx)
+		{
+			dma_fifo_set (uartx->dma_tx->reqsel, DMA_WIDTH_BYTE, DMA_BSIZE_8);
+		}
+
+		if (uartx->dma_rx)
+		{
+			dma_fifo_set (uartx->dma_rx->reqsel, DMA_WIDTH_BYTE, DMA_BSIZE_1);
+		}
 	}
 
 	uartx->info->flags = UART_FLAG_INITIALIZED;
@@ -316,9 +506,28 @@ static int32_t uart_initialize (AE350_UART_SignalEvent_t cb_event, UART_RESOURCE
 ******************************************************************************************/
 static int32_t uart_uninitialize (UART_RESOURCES *uartx)
 {
+	// Nothing owned before uart_initialize ()
+	if ((uartx->info->flags & UART_FLAG_INITIALIZED) == 0U)
+	{
+		return AE350_DRIVER_OK;
+	}
+
 	// DMA Un-initialize
 	if (uartx->dma_tx || uartx->dma_rx)
 	{
+		if (uartx->dma_tx)
+		{
+			dma_channel_release (uartx->info->dma_tx_ch);
+		}
+
+		if (uartx->dma_rx)
+		{
+			dma_channel_release (uartx->info->dma_rx_ch);
+		}
+
+		uartx->info->dma_tx_ch = DMA_CHANNEL_ANY;
+		uartx->info->dma_rx_ch = DMA_CHANNEL_ANY;
+
 		dma_uninitialize ();
 	}
 
@@ -349,13 +558,13 @@ static int32_t uart_power_control (AE350_POWER_STATE state, UART_RESOURCES *uart
 		// If DMA mode - disable TX DMA channel
 		if ((uartx->dma_tx) && (uartx->info->xfer.send_active != 0U))
 		{
-			dma_channel_disable (uartx->dma_tx->channel);
+			dma_channel_disable (uartx->info->dma_tx_ch);
 		}
 
 		// If DMA mode - disable DMA channel
 		if ((uartx->dma_rx) && (uartx->info->rx_status.rx_busy))
 		{
-			dma_channel_disable (uartx->dma_rx->channel);
+			dma_channel_disable (uartx->info->dma_rx_ch);
 		}
 
 		// Clear driver variables
@@ -483,24 +692,23 @@ static int32_t uart_send (const void *data, uint32_t num, UART_RESOURCES *uartx)
 	if (uartx->dma_tx)
 	{
 		// Configure DMA channel
-		stat = dma_channel_configure (uartx->dma_tx->channel,
-									  (uint32_t)(long)data,
-									  (uint32_t)(long)(&(uartx->reg->THR)),
-									  num,
-									  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-									  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-									  DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-									  DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
-									  DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-									  DMA_CH_CTRL_DMODE_HANDSHAKE |
-									  DMA_CH_CTRL_SRCADDR_INC |
-									  DMA_CH_CTRL_DSTADDR_FIX |
-									  DMA_CH_CTRL_DSTREQ(uartx->dma_tx->reqsel)	|
-									  DMA_CH_CTRL_INTABT |
-									  DMA_CH_CTRL_INTERR |
-									  DMA_CH_CTRL_INTTC	|
-									  DMA_CH_CTRL_ENABLE,
-									  uartx->dma_tx->cb_event);
+		stat = dma_channel_configure_auto (uartx->info->dma_tx_ch,
+									       uartx->info->dma_tx_desc,
+									       DMA_XFER_DESC,
+									       (uint32_t)(long)data,
+									       (uint32_t)(long)(&(uartx->reg->THR)),
+									       num,
+									       DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+									       DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+									       DMA_CH_CTRL_DMODE_HANDSHAKE |
+									       DMA_CH_CTRL_SRCADDR_INC |
+									       DMA_CH_CTRL_DSTADDR_FIX |
+									       DMA_CH_CTRL_DSTREQ(uartx->dma_tx->reqsel)	|
+									       DMA_CH_CTRL_INTABT |
+									       DMA_CH_CTRL_INTERR |
+									       DMA_CH_CTRL_INTTC	|
+									       DMA_CH_CTRL_ENABLE,
+									       uartx->dma_tx->cb_event);
 
 		if (stat == -1)
 		{
@@ -532,6 +740,12 @@ static int32_t uart_send (const void *data, uint32_t num, UART_RESOURCES *uartx)
                                      uint32_t         num,
                                      UART_RESOURCES  *uartx)
   \brief       Start receiving data from UART receiver.
+               With AE350_UART_CONTROL_RX_CONTINUOUS the buffer is filled in a circle
+               until the receive is aborted. AE350_UART_EVENT_RECEIVE_COMPLETE is
+               signaled for each filled half of the buffer and AE350_UART_EVENT_RX_TIMEOUT
+               at the end of each packet. uart_get_rxcount() then returns the number of
+               all data received, the data of count n is at index n % num. In DMA mode
+               num must be a multiple of 16 and at least 32.
   \param[out]  data  Pointer to buffer for data to receive from UART receiver
   \param[in]   num   Number of data items to receive
   \param[in]   uartx Pointer to UART resources
@@ -547,6 +761,13 @@ static int32_t uart_receive (void *data, uint32_t num, UART_RESOURCES *uartx)
 		return AE350_DRIVER_ERROR_PARAMETER;
 	}
 
+	if ((uartx->info->flags & UART_FLAG_RX_CONTINUOUS) && (uartx->dma_rx) &&
+		((num < 32U) || (num & 15U)))
+	{
+		// Halves of the buffer must be whole DMA bursts
+		return AE350_DRIVER_ERROR_PARAMETER;
+	}
+
 	if ((uartx->info->flags & UART_FLAG_CONFIGURED) == 0U)
 	{
 		// UART is not configured (mode not selected)
@@ -574,28 +795,43 @@ static int32_t uart_receive (void *data, uint32_t num, UART_RESOURCES *uartx)
 	// Save receive buffer info
 	uartx->info->xfer.rx_buf = (uint8_t *)data;
 	uartx->info->xfer.rx_cnt =              0U;
+	uartx->info->xfer.rx_pos =              0U;
 
+	// Continuous DMA mode
+	if ((uartx->dma_rx) && (uartx->info->flags & UART_FLAG_RX_CONTINUOUS))
+	{
+		// RX trigger level of one DMA burst
+		uartx->reg->FCR = UART_TRIG_LVL_8 | UARTC_FCR_DMA_EN | UARTC_FCR_FIFO_EN;
+
+		if (uart_rx_dma_next (uartx) != AE350_DRIVER_OK)
+		{
+			uartx->info->rx_status.rx_busy = 0U;
+			return AE350_DRIVER_ERROR;
+		}
+
+		// Character time-out interrupt at the end of a packet
+		uartx->reg->IER |= UARTC_IER_RDR;
+	}
 	// DMA mode
-	if (uartx->dma_rx)
+	else if (uartx->dma_rx)
 	{
-		stat = dma_channel_configure (uartx->dma_rx->channel,
-									  (uint32_t)(long)&uartx->reg->RBR,
-									  (uint32_t)(long)data,
-									  num,
-									  DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
-									  DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
-									  DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
-									  DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
-									  DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
-									  DMA_CH_CTRL_SMODE_HANDSHAKE |
-									  DMA_CH_CTRL_SRCADDR_FIX |
-									  DMA_CH_CTRL_DSTADDR_INC |
-									  DMA_CH_CTRL_SRCREQ(uartx->dma_rx->reqsel)	|
-									  DMA_CH_CTRL_INTABT |
-									  DMA_CH_CTRL_INTERR |
-									  DMA_CH_CTRL_INTTC |
-									  DMA_CH_CTRL_ENABLE,
-									  uartx->dma_rx->cb_event);
+		stat = dma_channel_configure_auto (uartx->info->dma_rx_ch,
+									       uartx->info->dma_rx_desc,
+									       DMA_XFER_DESC,
+									       (uint32_t)(long)&uartx->reg->RBR,
+									       (uint32_t)(long)data,
+									       num,
+									       DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+									       DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+									       DMA_CH_CTRL_SMODE_HANDSHAKE |
+									       DMA_CH_CTRL_SRCADDR_FIX |
+									       DMA_CH_CTRL_DSTADDR_INC |
+									       DMA_CH_CTRL_SRCREQ(uartx->dma_rx->reqsel)	|
+									       DMA_CH_CTRL_INTABT |
+									       DMA_CH_CTRL_INTERR |
+									       DMA_CH_CTRL_INTTC |
+									       DMA_CH_CTRL_ENABLE,
+									       uartx->dma_rx->cb_event);
 
 		if (stat == -1)
 		{
@@ -654,7 +890,7 @@ static uint32_t uart_get_txcount (UART_RESOURCES *uartx)
 
 	if (uartx->dma_tx)
 	{
-		cnt = dma_channel_get_count (uartx->dma_tx->channel);
+		cnt = dma_channel_get_count (uartx->info->dma_tx_ch);
 	}
 	else
 	{
@@ -674,9 +910,18 @@ static uint32_t uart_get_rxcount (UART_RESOURCES *uartx)
 {
 	uint32_t cnt;
 
-	if (uartx->dma_rx)
+	if ((uartx->dma_rx) && (uartx->info->flags & UART_FLAG_RX_CONTINUOUS))
+	{
+		// Data of the completed segments and of the running one
+		cnt = uartx->info->xfer.rx_cnt;
+		if (uartx->info->rx_status.rx_busy)
+		{
+			cnt += dma_channel_get_count (uartx->info->dma_rx_ch);
+		}
+	}
+	else if (uartx->dma_rx)
 	{
-		cnt = dma_channel_get_count (uartx->dma_rx->channel);
+		cnt = dma_channel_get_count (uartx->info->dma_rx_ch);
 	}
 	else
 	{
@@ -742,6 +987,24 @@ static int32_t uart_control (uint32_t control, uint32_t arg, UART_RESOURCES  *ua
 
 		return AE350_DRIVER_OK;
 
+	// Control continuous receive
+	case AE350_UART_CONTROL_RX_CONTINUOUS:
+		if (uartx->info->rx_status.rx_busy)
+		{
+			return AE350_DRIVER_ERROR_BUSY;
+		}
+
+		if (arg)
+		{
+			uartx->info->flags |= UART_FLAG_RX_CONTINUOUS;
+		}
+		else
+		{
+			uartx->info->flags &= ~UART_FLAG_RX_CONTINUOUS;
+		}
+
+		return AE350_DRIVER_OK;
+
 	// Control break
 	case AE350_UART_CONTROL_BREAK:
 		if (arg)
@@ -785,7 +1048,7 @@ static int32_t uart_control (uint32_t control, uint32_t arg, UART_RESOURCES  *ua
 		// If DMA mode - disable DMA channel
 		if ((uartx->dma_tx) && (uartx->info->xfer.send_active != 0U))
 		{
-			dma_channel_disable (uartx->dma_tx->channel);
+			dma_channel_disable (uartx->info->dma_tx_ch);
 		}
 
 		// Clear Send active flag
@@ -812,7 +1075,7 @@ static int32_t uart_control (uint32_t control, uint32_t arg, UART_RESOURCES  *ua
 		// If DMA mode - disable DMA channel
 		if ((uartx->dma_rx) && (uartx->info->rx_status.rx_busy))
 		{
-			dma_channel_disable (uartx->dma_rx->channel);
+			dma_channel_disable (uartx->info->dma_rx_ch);
 		}
 
 		// Clear RX busy status
@@ -828,12 +1091,12 @@ static int32_t uart_control (uint32_t control, uint32_t arg, UART_RESOURCES  *ua
 		// If DMA mode - disable DMA channel
 		if ((uartx->dma_tx) && (uartx->info->xfer.send_active != 0U))
 		{
-			dma_channel_disable (uartx->dma_tx->channel);
+			dma_channel_disable (uartx->info->dma_tx_ch);
 		}
 
 		if ((uartx->dma_rx) && (uartx->info->rx_status.rx_busy))
 		{
-			dma_channel_disable (uartx->dma_rx->channel);
+			dma_channel_disable (uartx->info->dma_rx_ch);
 		}
 
 		// Set trigger level
@@ -1192,9 +1455,17 @@ static void uart_irq_handler (UART_RESOURCES *uartx)
 			event |= uart_rxline_irq_handler(uartx);
 		}
 
+		// Continuous DMA mode, the DMA takes the data and the CPU the tail of a packet
+		if ((uartx->dma_rx) && (uartx->info->flags & UART_FLAG_RX_CONTINUOUS))
+		{
+			if (((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RTO) && (uartx->info->rx_status.rx_busy))
+			{
+				event |= uart_rx_dma_timeout (uartx);
+			}
+		}
 		// Receive data available and Character time-out indicator interrupt
-		if (((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RDA)  ||
-			((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RTO))
+		else if (((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RDA)  ||
+				 ((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RTO))
 		{
 			switch (uartx->trig_lvl)
 			{
@@ -1221,6 +1492,14 @@ static void uart_irq_handler (UART_RESOURCES *uartx)
 				// Check RX line interrupt for errors
 				event |= uart_rxline_irq_handler(uartx);
 
+				// Continuous mode, write in a circle
+				if (uartx->info->flags & UART_FLAG_RX_CONTINUOUS)
+				{
+					uartx->info->xfer.rx_buf[uartx->info->xfer.rx_pos] = uartx->reg->RBR;
+					event |= uart_rx_advance (uartx, 1U);
+					continue;
+				}
+
 				// Read data from RX FIFO into receive buffer
 				uartx->info->xfer.rx_buf[uartx->info->xfer.rx_cnt] = uartx->reg->RBR;
 
@@ -1244,8 +1523,9 @@ static void uart_irq_handler (UART_RESOURCES *uartx)
 		// Character time-out indicator
 		if ((iir & UARTC_IIR_INT_MASK) == UARTC_IIR_RTO)
 		{
-			// Signal RX Time-out event, if not all requested data received
-			if (uartx->info->xfer.rx_cnt != uartx->info->xfer.rx_num)
+			// Signal RX Time-out event, if not all requested data received or at the end of each packet in continuous mode
+			if ((uartx->info->flags & UART_FLAG_RX_CONTINUOUS) ||
+				(uartx->info->xfer.rx_cnt != uartx->info->xfer.rx_num))
 			{
 				event |= AE350_UART_EVENT_RX_TIMEOUT;
 			}
@@ -1334,6 +1614,32 @@ static void uart_dma_tx_event (uint32_t event, UART_RESOURCES *uartx)
 *******************************************************************************************/
 static void uart_dma_rx_event (uint32_t event, UART_RESOURCES *uartx)
 {
+	uint32_t ev;
+	unsigned long saved_mie;
+
+	// Continuous mode, the next segment starts right away, the RX FIFO holds the data meanwhile
+	if ((uartx->info->flags & UART_FLAG_RX_CONTINUOUS) && (event == DMA_EVENT_TERMINAL_COUNT_REQUEST))
+	{
+		// Not interrupted by the character time-out of the UART
+		saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+		ev = uart_rx_advance (uartx, uartx->info->xfer.rx_seg);
+
+		if (uart_rx_dma_next (uartx) != AE350_DRIVER_OK)
+		{
+			uartx->info->rx_status.rx_busy = 0U;
+		}
+
+		set_csr(NDS_MSTATUS, saved_mie);
+
+		if ((uartx->info->cb_event) && (ev != 0U))
+		{
+			uartx->info->cb_event (ev);
+		}
+
+		return;
+	}
+
 	switch (event)
 	{
 	case DMA_EVENT_TERMINAL_COUNT_REQUEST:
@@ -1439,12 +1745,18 @@ void uart1_dma_rx_event (uint32_t event)
 }
 #endif
 
-// UART1 interrupt handler
-void uart1_irq_handler (void)
+// UART1 interrupt handler of the driver
+void uart1_driver_irq_handler (void)
 {
 	uart_irq_handler (&uart1_resources);
 }
 
+// UART1 interrupt handler, weak so that the console in uart.c can own the UART1 interrupt
+__attribute__((weak)) void uart1_irq_handler (void)
+{
+	uart1_driver_irq_handler ();
+}
+
 
 // UART1 driver control block
 AE350_DRIVER_UART Driver_UART1 =
@@ -1550,12 +1862,18 @@ void uart2_dma_rx_event (uint32_t event)
 }
 #endif
 
-// UART2 interrupt handler
-void uart2_irq_handler (void)
+// UART2 interrupt handler of the driver
+void uart2_driver_irq_handler (void)
 {
 	uart_irq_handler (&uart2_resources);
 }
 
+// UART2 interrupt handler, weak so that the console in uart.c can own the UART2 interrupt
+__attribute__((weak)) void uart2_irq_handler (void)
+{
+	uart2_driver_irq_handler ();
+}
+
 
 // UART2 driver control block
 AE350_DRIVER_UART Driver_UART2 =
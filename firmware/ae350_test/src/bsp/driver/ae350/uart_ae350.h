@@ -119,6 +119,7 @@
 #define UART_FLAG_TX_ENABLED            (1U << 3)
 #define UART_FLAG_RX_ENABLED            (1U << 4)
 #define UART_FLAG_SEND_ACTIVE           (1U << 5)
+#define UART_FLAG_RX_CONTINUOUS         (1U << 6)
 
 // UART TX FIFO trigger level
 #define UART_TRIG_LVL_1                 (0x00U)
@@ -135,6 +136,8 @@ typedef struct _UART_TRANSFER_INFO
 	uint8_t                 *tx_buf;       // Pointer to out data buffer
 	uint32_t                rx_cnt;        // Number of data received
 	uint32_t                tx_cnt;        // Number of data sent
+	uint32_t                rx_pos;        // Write index of continuous receive
+	uint32_t                rx_seg;        // Size of the DMA segment of continuous receive
 	uint8_t                 tx_def_val;    // Transmit default value (used in UART_SYNC_MASTER_MODE_RX)
 	uint8_t                 send_active;   // Send active flag
 } UART_TRANSFER_INFO;
@@ -157,13 +160,17 @@ typedef struct _UART_INFO
 	UART_TRANSFER_INFO     xfer;          	// Transfer information
 	uint8_t                 mode;          	// UART mode
 	uint8_t                 flags;         	// UART driver flags
+	uint8_t                 dma_tx_ch;     	// DMA TX channel of dma_channel_request()
+	uint8_t                 dma_rx_ch;     	// DMA RX channel of dma_channel_request()
 	uint32_t                baudrate;      	// Baud rate
+	DMA_LLP_DESC            dma_tx_desc[DMA_XFER_DESC];	// DMA TX chain of the alignment
+	DMA_LLP_DESC            dma_rx_desc[DMA_XFER_DESC];	// DMA RX chain of the alignment
 } UART_INFO;
 
 // UART DMA
 typedef const struct _UART_DMA
 {
-	uint8_t                 channel;       	// DMA channel
+	uint8_t                 channel;       	// Preferred DMA channel
 	uint8_t                 reqsel;        	// DMA request selection
 	DMA_SignalEvent_t       cb_event;      	// DMA event callback
 } UART_DMA;
@@ -180,5 +187,9 @@ typedef struct
 	UART_INFO                 *info;         // Run-Time information
 } const UART_RESOURCES;
 
+// Driver interrupt handlers, for an owner of uartx_irq_handler() to pass the interrupt on
+extern void uart1_driver_irq_handler (void);
+extern void uart2_driver_irq_handler (void);
+
 
 #endif /* __UART_AE350_H__ */
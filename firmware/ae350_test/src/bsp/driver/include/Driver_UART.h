@@ -89,6 +89,7 @@
 #define AE350_UART_ABORT_SEND                (0x18UL << AE350_UART_CONTROL_Pos)   // Abort \ref AE350_UART_Send
 #define AE350_UART_ABORT_RECEIVE             (0x19UL << AE350_UART_CONTROL_Pos)   // Abort \ref AE350_UART_Receive
 #define AE350_UART_ABORT_TRANSFER            (0x1AUL << AE350_UART_CONTROL_Pos)   // Abort \ref AE350_UART_Transfer
+#define AE350_UART_CONTROL_RX_CONTINUOUS     (0x1BUL << AE350_UART_CONTROL_Pos)   // Continuous receive into a circular buffer; arg: 0=disabled, 1=enabled
 
 
 /****** UART specific error codes *****/
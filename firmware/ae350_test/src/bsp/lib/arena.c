@@ -0,0 +1,112 @@
+/*
+ * ******************************************************************************************
+ * File		: arena.c
+ * Author 	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Arena allocator
+ * ******************************************************************************************
+ */
+
+/*
+ * An arena takes one block from the heap and hands out memory from it by moving a pointer
+ * forward. Nothing is freed individually: mem_arena_restore() moves the pointer back to a
+ * saved position, releasing in one step all allocations made since, and mem_arena_reset()
+ * releases the whole arena. Saved positions nest, so a frame can save on entry and restore
+ * on exit while callees do the same.
+ */
+
+// Includes ---------------------------------------------------------------------------------
+#include "arena.h"
+#include "mm.h"
+
+
+// Definitions ------------------------------------------------------------------------------
+
+#define ARENA_ALIGN_SIZE		8
+
+
+// Get arena memory from a heap region, returns 0 on success
+int mem_arena_init(mem_arena_t *arena, unsigned int size, unsigned int region)
+{
+	arena->base = mem_malloc_region(size, region);
+	arena->ptr = arena->base;
+	arena->end = arena->base ? arena->base + size : 0;
+	arena->peak = 0;
+	arena->fail = 0;
+
+	return arena->base ? 0 : -1;
+}
+
+// Return arena memory to the heap
+void mem_arena_deinit(mem_arena_t *arena)
+{
+	mem_free(arena->base);
+
+	arena->base = 0;
+	arena->ptr = 0;
+	arena->end = 0;
+}
+
+// Allocate, align is a power of 2
+void* mem_arena_alloc_aligned(mem_arena_t *arena, unsigned int size, unsigned int align)
+{
+	unsigned char *ptr = (unsigned char *)(((unsigned long)arena->ptr + align - 1) & ~(unsigned long)(align - 1));
+	unsigned int used;
+
+	// Aligning may wrap around or step past the end of the arena
+	if((ptr < arena->ptr) || (ptr > arena->end) || (size > (unsigned long)(arena->end - ptr)))
+	{
+		arena->fail++;
+		return 0;
+	}
+
+	arena->ptr = ptr + size;
+
+	used = arena->ptr - arena->base;
+	if(used > arena->peak)
+	{
+		arena->peak = used;
+	}
+
+	return ptr;
+}
+
+// Allocate, 8 bytes aligned
+void* mem_arena_alloc(mem_arena_t *arena, unsigned int size)
+{
+	// Rounding up the largest sizes would wrap to 0
+	if(size > ~0U - (ARENA_ALIGN_SIZE - 1))
+	{
+		arena->fail++;
+		return 0;
+	}
+
+	return mem_arena_alloc_aligned(arena, (size + ARENA_ALIGN_SIZE - 1) & ~(ARENA_ALIGN_SIZE - 1), ARENA_ALIGN_SIZE);
+}
+
+// Save the position
+mem_arena_mark_t mem_arena_save(mem_arena_t *arena)
+{
+	return arena->ptr;
+}
+
+// Release everything allocated after the mark was saved
+void mem_arena_restore(mem_arena_t *arena, mem_arena_mark_t mark)
+{
+	if((mark >= arena->base) && (mark <= arena->ptr))
+	{
+		arena->ptr = mark;
+	}
+}
+
+// Release everything
+void mem_arena_reset(mem_arena_t *arena)
+{
+	arena->ptr = arena->base;
+}
+
+// Bytes in use
+unsigned int mem_arena_used(mem_arena_t *arena)
+{
+	return arena->ptr - arena->base;
+}
@@ -0,0 +1,41 @@
+/*
+ * ******************************************************************************************
+ * File		: arena.h
+ * Author 	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Arena allocator
+ * ******************************************************************************************
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+
+// Definitions ------------------------------------------------------------------------------
+
+typedef struct _mem_arena
+{
+	unsigned char *base;				// Arena memory, from the heap
+	unsigned char *ptr;					// Next free byte
+	unsigned char *end;					// End of the arena memory
+	unsigned int peak;					// Peak bytes in use since init
+	unsigned int fail;					// Allocations not fitting in the arena
+} mem_arena_t;
+
+// Saved arena position, see mem_arena_save()
+typedef unsigned char* mem_arena_mark_t;
+
+
+// Declarations -----------------------------------------------------------------------------
+
+extern int mem_arena_init(mem_arena_t *arena, unsigned int size, unsigned int region);	// Get arena memory from a heap region
+extern void mem_arena_deinit(mem_arena_t *arena);									// Return arena memory to the heap
+extern void* mem_arena_alloc(mem_arena_t *arena, unsigned int size);				// Allocate, 8 bytes aligned
+extern void* mem_arena_alloc_aligned(mem_arena_t *arena, unsigned int size, unsigned int align);	// Allocate, align is a power of 2
+extern mem_arena_mark_t mem_arena_save(mem_arena_t *arena);							// Save the position
+extern void mem_arena_restore(mem_arena_t *arena, mem_arena_mark_t mark);			// Release everything allocated after a save
+extern void mem_arena_reset(mem_arena_t *arena);									// Release everything
+extern unsigned int mem_arena_used(mem_arena_t *arena);								// Bytes in use
+
+
+#endif	/* __ARENA_H__ */
@@ -0,0 +1,106 @@
+/*
+ * ******************************************************************************************
+ * File		: log.c
+ * Author	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Deferred binary logging
+ * ******************************************************************************************
+ */
+
+/*
+ * A record is
+ *
+ *   0xA5 0x4C  length  payload[length]  sum
+ *
+ * where the payload is the format string ID, the 'mcycle' delta since the previous
+ * record, the number of arguments and the arguments, each an unsigned LEB128 value
+ * (7 bits per byte, bit 7 set when more bytes follow), and sum is the 8-bit sum of
+ * the payload. Most IDs, deltas and arguments fit in one to three bytes.
+ *
+ * The record is built on the stack and queued with one uart_write(), so records from
+ * interrupt handlers never split another one.
+ */
+
+// Includes ---------------------------------------------------------------------------------
+#include <stdarg.h>
+#include "log.h"
+#include "uart.h"
+#include "platform.h"
+
+
+// Definitions ------------------------------------------------------------------------------
+
+static unsigned long log_last_cycle;
+
+// Append an unsigned LEB128 value
+static inline unsigned char* log_put_value(unsigned char *p, unsigned int v)
+{
+	while(v >= 0x80)
+	{
+		*p++ = (v & 0x7F) | 0x80;
+		v >>= 7;
+	}
+
+	*p++ = v;
+
+	return p;
+}
+
+// Send a binary log record
+void log_write(unsigned int id, unsigned int nargs, ...)
+{
+	// Sync, length, ID, delta and count, arguments, sum; 5 bytes at most per value
+	unsigned char args[LOG_MAX_ARGS*5];
+	unsigned char rec[3 + 3*5 + sizeof(args) + 1];
+	unsigned char *a = args;
+	unsigned char *p;
+	unsigned char *q;
+	unsigned long saved_mie;
+	unsigned long cycle;
+	unsigned char sum = 0;
+	unsigned int i;
+	va_list ap;
+
+	if(nargs > LOG_MAX_ARGS)
+	{
+		nargs = LOG_MAX_ARGS;
+	}
+
+	va_start(ap, nargs);
+	for(i = 0;i < nargs;i++)
+	{
+		a = log_put_value(a, va_arg(ap, unsigned int));
+	}
+	va_end(ap);
+
+	// The time stamp and the record are ordered with the other records
+	saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	cycle = read_csr(NDS_MCYCLE);
+
+	p = rec + 3;
+	p = log_put_value(p, id);
+	p = log_put_value(p, cycle - log_last_cycle);
+	p = log_put_value(p, nargs);
+
+	for(q = args;q < a;q++)
+	{
+		*p++ = *q;
+	}
+
+	for(q = rec + 3;q < p;q++)
+	{
+		sum += *q;
+	}
+
+	rec[0] = LOG_SYNC0;
+	rec[1] = LOG_SYNC1;
+	rec[2] = p - (rec + 3);
+	*p++ = sum;
+
+	log_last_cycle = cycle;
+
+	uart_write(rec, p - rec);
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
@@ -0,0 +1,73 @@
+/*
+ * ******************************************************************************************
+ * File		: log.h
+ * Author	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Deferred binary logging
+ * ******************************************************************************************
+ */
+
+#ifndef __LOG_H__
+#define __LOG_H__
+
+
+// Includes ----------------------------------------------------------------------------------
+#include <stdio.h>
+
+
+// Definitions -------------------------------------------------------------------------------
+
+/*
+ * LOG(fmt, ...) prints like printf(). With LOG_BINARY it sends a record instead:
+ * the format string ID, the cycles since the previous record and the raw arguments.
+ * The format strings live in the non-loaded section .logfmt and are never sent,
+ * tools/logdec.py reads them from the ELF file and prints the text on the host.
+ *
+ * Arguments are 32-bit, up to LOG_MAX_ARGS. %s only decodes pointers to strings
+ * in the ELF file, e.g. literals.
+ */
+#ifndef LOG_BINARY
+#define LOG_BINARY				0		// 1: binary records; 0: printf()
+#endif
+
+#define LOG_MAX_ARGS			8
+
+// Record sync bytes, a record is sync, length, payload, 8-bit sum of the payload
+#define LOG_SYNC0				0xA5
+#define LOG_SYNC1				0x4C
+
+#if LOG_BINARY
+
+// Count 0..8 arguments
+#define LOG_NARGS(...)			LOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_, a1, a2, a3, a4, a5, a6, a7, a8, n, ...)	n
+
+// Address of a format string in .logfmt, loaded as an absolute constant
+#define LOG_ID(s)																\
+	({																			\
+		unsigned int _id;														\
+		__asm__ ("lui %0, %%hi(%1)\n\taddi %0, %0, %%lo(%1)" : "=r"(_id) : "i"(s));	\
+		_id;																	\
+	})
+
+// The assembler comment hides the "a" flag that GCC appends, so .logfmt is not loaded
+#define LOG(fmt, ...)															\
+	do																			\
+	{																			\
+		static const char _log_fmt[] __attribute__((section(".logfmt,\"\",@progbits #"), used)) = fmt;	\
+		log_write(LOG_ID(_log_fmt), LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);		\
+	} while(0)
+
+#else
+
+#define LOG(fmt, ...)			printf(fmt, ##__VA_ARGS__)
+
+#endif	/* LOG_BINARY */
+
+
+// Declarations ------------------------------------------------------------------------------
+
+extern void log_write(unsigned int id, unsigned int nargs, ...);	// Send a binary log record
+
+
+#endif	/* __LOG_H__ */
@@ -7,36 +7,129 @@
  * ******************************************************************************************
  */
 
+/*
+ * The heap is managed by a two-level segregated fit (TLSF) allocator.
+ *
+ * Free blocks are kept in an array of lists indexed by two levels. The first level
+ * splits sizes in power of two classes, the second level splits each class linearly
+ * into MEM_SL_INDEX_COUNT lists. Two bitmaps record which lists are not empty, so
+ * finding a suitable free block is a couple of bit scans and both allocation and free
+ * run in bounded constant time, whatever the heap size or its fragmentation.
+ *
+ * Every block starts with a header holding the previous physical block and the payload
+ * size. Free neighbours are coalesced immediately on free.
+ */
+
 // Includes ---------------------------------------------------------------------------------
 #include "mm.h"
+#include "platform.h"
+#include "uart.h"
+
+// If enable L1 cache
+#ifdef CFG_CACHE_ENABLE
+#include "cache.h"
+#endif
 
 
 // Declarations -----------------------------------------------------------------------------
-static unsigned int my_malloc(unsigned int size);
-static unsigned char my_free(unsigned int offset);
+typedef struct _mem_block mem_block_t;
+typedef struct _mem_control mem_control_t;
+typedef unsigned long __attribute__((may_alias)) mem_word_t;
+
+static void mem_control_init(mem_control_t *control);
+static void mem_pool_add(mem_control_t *control, void *mem, unsigned long bytes);
+static void* mem_pool_malloc(mem_control_t *control, unsigned int size);
+static void* mem_pool_memalign(mem_control_t *control, unsigned long align, unsigned int size);
+static void mem_pool_free(mem_control_t *control, void *ptr);
+static void* mem_pool_realloc(mem_control_t *control, void *ptr, unsigned int size);
 static unsigned char mem_perused(void);
+static struct _mem_region* mem_region_get(unsigned int region);
+static inline int mem_fls(unsigned long x);
+static inline unsigned long block_size(const mem_block_t *block);
+static inline mem_block_t* block_from_ptr(const void *ptr);
 
 
 // Definitions ------------------------------------------------------------------------------
 
-#define MEM_BLOCK_SIZE          8
-#define MEM_MAX_SIZE            8192		// Self-defined
-#define MEM_ALLOC_TABLE_SIZE    MEM_MAX_SIZE/MEM_BLOCK_SIZE
+#define MEM_ALIGN_SIZE_LOG2			3
+#define MEM_ALIGN_SIZE				(1 << MEM_ALIGN_SIZE_LOG2)	// Allocation granularity
+
+// Second level lists per first level class (log2)
+#define MEM_SL_INDEX_COUNT_LOG2		4
+#define MEM_SL_INDEX_COUNT			(1 << MEM_SL_INDEX_COUNT_LOG2)
+
+// Sizes below MEM_SMALL_BLOCK_SIZE all fall into the first level class 0
+#define MEM_FL_INDEX_SHIFT			(MEM_SL_INDEX_COUNT_LOG2 + MEM_ALIGN_SIZE_LOG2)
+#define MEM_FL_INDEX_COUNT			(MEM_FL_INDEX_MAX - MEM_FL_INDEX_SHIFT + 1)
+#define MEM_SMALL_BLOCK_SIZE		(1 << MEM_FL_INDEX_SHIFT)
+
+// Block size word, bit 0 marks a free block
+#define MEM_BLOCK_FREE_BIT			1UL
+
+// Block header overhead and the smallest block the allocator handles
+#define MEM_BLOCK_HDR_SIZE			((unsigned long)__builtin_offsetof(mem_block_t, next_free))
+#define MEM_BLOCK_SIZE_MIN			(sizeof(mem_block_t) - MEM_BLOCK_HDR_SIZE)
+#define MEM_BLOCK_SIZE_MAX			(1UL << MEM_FL_INDEX_MAX)
+
+// Word moved by mem_cpy/mem_set/mem_cmp, native register width
+#define MEM_WORD_SIZE				sizeof(mem_word_t)
+#define MEM_WORD_MASK				(MEM_WORD_SIZE - 1)
+
+// Statistics record, see mem_stats_send()
+#define MEM_STATS_MAGIC0			0xA5
+#define MEM_STATS_MAGIC1			0x4D
+#define MEM_STATS_WORDS				7
+
+#define MEM_ALIGN_UP(x)				(((x) + (MEM_ALIGN_SIZE - 1)) & ~(unsigned long)(MEM_ALIGN_SIZE - 1))
+#define MEM_ALIGN_DOWN(x)			((x) & ~(unsigned long)(MEM_ALIGN_SIZE - 1))
+
+// Block header, the free list links overlay the payload of a free block
+struct _mem_block
+{
+	mem_block_t		*prev_phys;		// Previous physical block, 0 for the first one
+	unsigned long	size;			// Payload size, bit 0 set when the block is free
+	mem_block_t		*next_free;		// Next free block in the same list
+	mem_block_t		*prev_free;		// Previous free block in the same list
+};
+
+// Allocator control
+struct _mem_control
+{
+	mem_block_t		null_block;		// Terminates every free list
+	unsigned int	fl_bitmap;		// First level, bit set if the class has a free block
+	unsigned int	sl_bitmap[MEM_FL_INDEX_COUNT];
+	mem_block_t		*blocks[MEM_FL_INDEX_COUNT][MEM_SL_INDEX_COUNT];
+
+	// Statistics, updated on each allocation and free
+	unsigned long	total;			// Bytes handed to the allocator
+	unsigned long	used;			// Payload bytes of the used blocks
+	unsigned long	peak;			// Peak of used
+	unsigned int	fragments;		// Free blocks
+	unsigned int	fail;			// Failed allocations
+	unsigned int	moves;			// Reallocations moving the data
+};
 
 struct _m_malloc_dev
 {
 	void 			(*init)(void);
 	unsigned char	(*perused)(void);
 	unsigned char	*membase;
-	unsigned char	*memmap;
+	mem_control_t	*control;
 	unsigned char	memrdy;
 };
 
-unsigned char membase[MEM_MAX_SIZE];
-unsigned char memmapbase[MEM_ALLOC_TABLE_SIZE];
+// Heap region
+struct _mem_region
+{
+	mem_control_t	*control;
+	unsigned long	start;
+	unsigned long	end;
+	unsigned char	state;			// 0: not initialized, 1: ready, 2: not available
+};
+
+unsigned char membase[MEM_MAX_SIZE] __attribute__((aligned(MEM_ALIGN_SIZE)));
+static mem_control_t memcontrol;
 
-const unsigned int memtblsize = MEM_ALLOC_TABLE_SIZE;
-const unsigned int memblksize = MEM_BLOCK_SIZE;
 const unsigned int memsize = MEM_MAX_SIZE;
 
 struct _m_malloc_dev malloc_dev =
@@ -44,79 +137,377 @@ struct _m_malloc_dev malloc_dev =
 	mem_init,
 	mem_perused,
 	membase,
-	memmapbase,
+	&memcontrol,
 	0,
 };
 
+// Region heaps, then the DMA heap
+static struct _mem_region mem_region[MEM_REGION_NUM + 1];
+
+// Fallback order, from the fastest memory to the largest one
+static const unsigned char mem_region_order[MEM_REGION_NUM] =
+{
+	MEM_REGION_DLM,
+	MEM_REGION_ILM,
+	MEM_REGION_DEFAULT,
+	MEM_REGION_DDR,
+};
+
+// Linker script symbols, see bsp/sag
+extern char _end;
+extern char _stack;
+
 
 // Initialize
 void mem_init(void)
 {
-	mem_set(malloc_dev.memmap, 0, memtblsize*2);
-	mem_set(malloc_dev.membase, 0, memsize);
+	mem_control_init(malloc_dev.control);
+	mem_pool_add(malloc_dev.control, malloc_dev.membase, memsize);
 	malloc_dev.memrdy = 1;
+
+	mem_region[MEM_REGION_DEFAULT].control = malloc_dev.control;
+	mem_region[MEM_REGION_DEFAULT].start = (unsigned long)malloc_dev.membase;
+	mem_region[MEM_REGION_DEFAULT].end = (unsigned long)malloc_dev.membase + memsize;
+	mem_region[MEM_REGION_DEFAULT].state = 1;
 }
 
 // Allocate
 void* mem_malloc(unsigned int size)
 {
-	unsigned int offset;
+	if(!malloc_dev.memrdy)
+	{
+		malloc_dev.init();
+	}
+
+	return mem_pool_malloc(malloc_dev.control, size);
+}
 
-	offset = my_malloc(size);
+// Allocate in a region, optionally falling back to the next regions of mem_region_order
+void* mem_malloc_region(unsigned int size, unsigned int region)
+{
+	unsigned int id = region & ~MEM_REGION_FALLBACK;
+	struct _mem_region *rgn;
+	void *ptr = 0;
+	int i;
 
-	if(offset == 0xFFFFFFFF)
+	if(id >= MEM_REGION_NUM)
 	{
 		return 0;
 	}
-	else
+
+	for(i = 0;mem_region_order[i] != id;i++);
+
+	for(;i < MEM_REGION_NUM;i++)
 	{
-		return (void*)((unsigned int)malloc_dev.membase + offset);
+		rgn = mem_region_get(mem_region_order[i]);
+		if(rgn)
+		{
+			ptr = mem_pool_malloc(rgn->control, size);
+		}
+
+		if(ptr || !(region & MEM_REGION_FALLBACK))
+		{
+			break;
+		}
 	}
+
+	return ptr;
+}
+
+// Bytes managed by a region, 0 if the region is not available
+unsigned int mem_region_size(unsigned int region)
+{
+	struct _mem_region *rgn = (region < MEM_REGION_NUM) ? mem_region_get(region) : 0;
+
+	return rgn ? (unsigned int)(rgn->end - rgn->start) : 0;
+}
+
+// Alignment and padding of the DMA buffers
+static unsigned long mem_dma_line_size(void)
+{
+#ifdef CFG_CACHE_ENABLE
+	if(cache_line_size() > MEM_ALIGN_SIZE)
+	{
+		return cache_line_size();
+	}
+#endif
+
+	return MEM_ALIGN_SIZE;
+}
+
+// Check if an address lies in a region
+static int mem_region_has(int region, unsigned long addr)
+{
+	return (mem_region[region].state == 1) && (addr >= mem_region[region].start) && (addr < mem_region[region].end);
+}
+
+// Region owning an allocation, -1 if none
+static int mem_region_find(void *ptr)
+{
+	unsigned long addr = (unsigned long)ptr;
+	int i;
+
+	// The DMA heap is a block of DDR, it goes first
+	if(mem_region_has(MEM_REGION_DMA, addr))
+	{
+		return MEM_REGION_DMA;
+	}
+
+	for(i = 0;i < MEM_REGION_NUM;i++)
+	{
+		if(mem_region_has(i, addr))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Allocate a DMA buffer. The buffer starts on a cache line and its size is padded to whole
+ * lines, so none of its lines is shared with other data. The DMA heap is registered to the
+ * cache driver, which then invalidates line aligned ranges of those buffers by whole lines
+ * with no partial-line handling. The DMA heap is carved out of DDR, the static heap is much
+ * smaller than MEM_DMA_SIZE. The buffer must not be accessed by the CPU while a transfer
+ * is in progress.
+ */
+void* mem_malloc_dma(unsigned int size)
+{
+	struct _mem_region *rgn = &mem_region[MEM_REGION_DMA];
+	unsigned long line_size = mem_dma_line_size();
+	unsigned long start;
+
+	if(rgn->state == 0)
+	{
+		// Carve the DMA heap out of DDR
+		start = (unsigned long)mem_malloc_region(MEM_DMA_SIZE, MEM_REGION_DDR);
+
+		if(start)
+		{
+			rgn->control = (mem_control_t *)start;
+			rgn->start = start;
+			rgn->end = start + MEM_DMA_SIZE;
+
+			mem_control_init(rgn->control);
+			mem_pool_add(rgn->control, rgn->control + 1, rgn->end - (unsigned long)(rgn->control + 1));
+			rgn->state = 1;
+
+#ifdef CFG_CACHE_ENABLE
+			ae350_dma_set_line_safe(rgn->start, MEM_DMA_SIZE);
+#endif
+		}
+		else
+		{
+			rgn->state = 2;
+		}
+	}
+
+	if((rgn->state != 1) || !size || (size > MEM_DMA_SIZE))
+	{
+		return 0;
+	}
+
+	return mem_pool_memalign(rgn->control, line_size, (size + line_size - 1) & ~(line_size - 1));
 }
 
 // Free
 void mem_free(void *ptr)
 {
-	unsigned int offset;
+	int region = mem_region_find(ptr);
+
+	// Ignore pointers not belonging to any heap
+	if(region >= 0)
+	{
+		mem_pool_free(mem_region[region].control, ptr);
+	}
+}
+
+/*
+ * Resize an allocation. The block grows in place over a free block following it and
+ * shrinks in place by giving back its tail. Only otherwise the data is moved to a new
+ * block of the same heap. Returns 0 on failure, the allocation is then left unchanged.
+ */
+void* mem_realloc(void *ptr, unsigned int size)
+{
+	int region = mem_region_find(ptr);
+	unsigned long line_size;
+	void *new_ptr;
 
 	if(!ptr)
 	{
-		return;
+		return mem_malloc(size);
 	}
 
-	offset = (unsigned int)ptr - (unsigned int)malloc_dev.membase;
+	if(region < 0)
+	{
+		return 0;
+	}
+
+	if(!size)
+	{
+		mem_pool_free(mem_region[region].control, ptr);
+		return 0;
+	}
+
+	if(region == MEM_REGION_DMA)
+	{
+		// Keep DMA buffers padded to whole cache lines
+		line_size = mem_dma_line_size();
+		size = (size + line_size - 1) & ~(line_size - 1);
+	}
+
+	new_ptr = mem_pool_realloc(mem_region[region].control, ptr, size);
+	if(new_ptr)
+	{
+		return new_ptr;
+	}
+
+	// Move to a new block as a last resort
+	new_ptr = (region == MEM_REGION_DMA) ? mem_malloc_dma(size) : mem_pool_malloc(mem_region[region].control, size);
+	if(new_ptr)
+	{
+		mem_cpy(new_ptr, ptr, block_size(block_from_ptr(ptr)) < size ? block_size(block_from_ptr(ptr)) : size);
+		mem_pool_free(mem_region[region].control, ptr);
+		mem_region[region].control->moves++;
+	}
 
-	my_free(offset);
+	return new_ptr;
 }
 
 // Compare
 int mem_cmp(void *des, void *src, unsigned int n)
 {
-	int iRet = 0;
-	unsigned char *xdes = des;
-	unsigned char *xsrc = src;
+	const unsigned char *xdes = des;
+	const unsigned char *xsrc = src;
+	const mem_word_t *wdes;
+	const mem_word_t *wsrc;
 
-	while(n--)
+	// Compare words when both pointers can be aligned together
+	if((n >= 2*MEM_WORD_SIZE) && !(((unsigned long)xdes ^ (unsigned long)xsrc) & MEM_WORD_MASK))
 	{
-		if(*xdes++ == *xsrc++)
+		while((unsigned long)xdes & MEM_WORD_MASK)
 		{
-			iRet |= 0;	// Equal
+			if(*xdes++ != *xsrc++)
+			{
+				return 1;	// Not equal
+			}
+			n--;
 		}
-		else
+
+		wdes = (const mem_word_t *)xdes;
+		wsrc = (const mem_word_t *)xsrc;
+
+		while(n >= 4*MEM_WORD_SIZE)
 		{
-			iRet |= 1;	// Not equal
+			if((wdes[0] ^ wsrc[0]) | (wdes[1] ^ wsrc[1]) | (wdes[2] ^ wsrc[2]) | (wdes[3] ^ wsrc[3]))
+			{
+				return 1;	// Not equal
+			}
+			wdes += 4;
+			wsrc += 4;
+			n -= 4*MEM_WORD_SIZE;
 		}
+
+		while(n >= MEM_WORD_SIZE)
+		{
+			if(*wdes++ != *wsrc++)
+			{
+				return 1;	// Not equal
+			}
+			n -= MEM_WORD_SIZE;
+		}
+
+		xdes = (const unsigned char *)wdes;
+		xsrc = (const unsigned char *)wsrc;
 	}
 
-	return iRet;
+	while(n--)
+	{
+		if(*xdes++ != *xsrc++)
+		{
+			return 1;	// Not equal
+		}
+	}
+
+	return 0;	// Equal
 }
 
 // Copy
 void mem_cpy(void *des, void *src, unsigned int n)
 {
 	unsigned char *xdes = des;
-	unsigned char *xsrc = src;
+	const unsigned char *xsrc = src;
+	mem_word_t *wdes;
+	const mem_word_t *wsrc;
+
+	if(n < 2*MEM_WORD_SIZE)
+	{
+		while(n--)
+		{
+			*xdes++ = *xsrc++;
+		}
+
+		return;
+	}
+
+	// Head bytes up to the destination word boundary
+	while((unsigned long)xdes & MEM_WORD_MASK)
+	{
+		*xdes++ = *xsrc++;
+		n--;
+	}
+
+	wdes = (mem_word_t *)xdes;
+
+	if(!((unsigned long)xsrc & MEM_WORD_MASK))
+	{
+		// Source aligned as well, move 8 words per iteration
+		wsrc = (const mem_word_t *)xsrc;
+
+		while(n >= 8*MEM_WORD_SIZE)
+		{
+			mem_word_t w0 = wsrc[0], w1 = wsrc[1], w2 = wsrc[2], w3 = wsrc[3];
+			mem_word_t w4 = wsrc[4], w5 = wsrc[5], w6 = wsrc[6], w7 = wsrc[7];
 
+			wdes[0] = w0; wdes[1] = w1; wdes[2] = w2; wdes[3] = w3;
+			wdes[4] = w4; wdes[5] = w5; wdes[6] = w6; wdes[7] = w7;
+			wdes += 8;
+			wsrc += 8;
+			n -= 8*MEM_WORD_SIZE;
+		}
+
+		while(n >= MEM_WORD_SIZE)
+		{
+			*wdes++ = *wsrc++;
+			n -= MEM_WORD_SIZE;
+		}
+
+		xsrc = (const unsigned char *)wsrc;
+	}
+	else
+	{
+		// Source misaligned, read aligned words and merge neighbours by shifts (little endian)
+		unsigned int shr = ((unsigned long)xsrc & MEM_WORD_MASK) * 8;
+		unsigned int shl = MEM_WORD_SIZE*8 - shr;
+		mem_word_t prev, next;
+
+		wsrc = (const mem_word_t *)((unsigned long)xsrc & ~(unsigned long)MEM_WORD_MASK);
+		prev = *wsrc++;
+
+		while(n >= MEM_WORD_SIZE)
+		{
+			next = *wsrc++;
+			*wdes++ = (prev >> shr) | (next << shl);
+			prev = next;
+			n -= MEM_WORD_SIZE;
+		}
+
+		xsrc = (const unsigned char *)wsrc - MEM_WORD_SIZE + shr/8;
+	}
+
+	// Tail bytes
+	xdes = (unsigned char *)wdes;
 	while(n--)
 	{
 		*xdes++ = *xsrc++;
@@ -127,7 +518,41 @@ void mem_cpy(void *des, void *src, unsigned int n)
 void mem_set(void *s, unsigned char c, unsigned int count)
 {
 	unsigned char *xs = s;
+	mem_word_t *ws;
+	mem_word_t w;
+
+	if(count >= 2*MEM_WORD_SIZE)
+	{
+		// Head bytes up to the word boundary
+		while((unsigned long)xs & MEM_WORD_MASK)
+		{
+			*xs++ = c;
+			count--;
+		}
+
+		// Replicate the byte over a word, ~0/0xFF is 0x0101...01
+		w = (~(mem_word_t)0 / 0xFF) * c;
+
+		ws = (mem_word_t *)xs;
 
+		while(count >= 8*MEM_WORD_SIZE)
+		{
+			ws[0] = w; ws[1] = w; ws[2] = w; ws[3] = w;
+			ws[4] = w; ws[5] = w; ws[6] = w; ws[7] = w;
+			ws += 8;
+			count -= 8*MEM_WORD_SIZE;
+		}
+
+		while(count >= MEM_WORD_SIZE)
+		{
+			*ws++ = w;
+			count -= MEM_WORD_SIZE;
+		}
+
+		xs = (unsigned char *)ws;
+	}
+
+	// Tail bytes
 	while(count--)
 	{
 		*xs++ = c;
@@ -137,94 +562,701 @@ void mem_set(void *s, unsigned char c, unsigned int count)
 // Perused
 static unsigned char mem_perused(void)
 {
-	unsigned int used = 0;
-	unsigned int i;
+	if(!malloc_dev.memrdy)
+	{
+		return 0;
+	}
 
-	for(i = 0;i < memtblsize;i++)
+	return (malloc_dev.control->used*100)/memsize;
+}
+
+// Heap statistics of a region or of the DMA heap, returns 0 on success
+int mem_stats(unsigned int region, mem_stats_t *stats)
+{
+	struct _mem_region *rgn = 0;
+	mem_control_t *control;
+	mem_block_t *block;
+	unsigned long largest = 0;
+	int fl, sl;
+
+	if(region < MEM_REGION_NUM)
+	{
+		rgn = mem_region_get(region);
+	}
+	else if((region == MEM_REGION_DMA) && (mem_region[MEM_REGION_DMA].state == 1))
+	{
+		rgn = &mem_region[MEM_REGION_DMA];
+	}
+
+	if(!rgn)
+	{
+		return -1;
+	}
+
+	control = rgn->control;
+
+	// The largest free block is in the highest non-empty list
+	if(control->fl_bitmap)
 	{
-		if(malloc_dev.memmap[i])
+		fl = mem_fls(control->fl_bitmap);
+		sl = mem_fls(control->sl_bitmap[fl]);
+
+		for(block = control->blocks[fl][sl];block != &control->null_block;block = block->next_free)
 		{
-			used++;
+			if(block_size(block) > largest)
+			{
+				largest = block_size(block);
+			}
 		}
 	}
 
-	return (used*100)/(memtblsize);
+	stats->total = control->total;
+	stats->used = control->used;
+	stats->peak = control->peak;
+	stats->largest_free = largest;
+	stats->fragments = control->fragments;
+	stats->fail = control->fail;
+	stats->moves = control->moves;
+
+	return 0;
 }
 
-// Allocate
-static unsigned int my_malloc(unsigned int size)
+/*
+ * Send the statistics of a region as one binary record:
+ * 0xA5 0x4D, payload length, then the payload: region and the mem_stats_t words
+ * in little endian, last the 8-bit sum of the payload. The record is queued with one
+ * uart_write(), so output from interrupt handlers never splits it.
+ */
+int mem_stats_send(unsigned int region)
 {
-	signed long offset = 0;
-	unsigned int nmemb;
-	unsigned int cmemb=0;
-	unsigned int i;
+	mem_stats_t stats;
+	unsigned int word[MEM_STATS_WORDS];
+	unsigned char rec[3 + 1 + 4*MEM_STATS_WORDS + 1];
+	unsigned char *p = rec + 3;
+	unsigned char sum;
+	int i, j;
 
-	if(!malloc_dev.memrdy)
+	if(mem_stats(region, &stats))
 	{
-		malloc_dev.init();
+		return -1;
 	}
 
-	if(size == 0)
+	word[0] = stats.total;
+	word[1] = stats.used;
+	word[2] = stats.peak;
+	word[3] = stats.largest_free;
+	word[4] = stats.fragments;
+	word[5] = stats.fail;
+	word[6] = stats.moves;
+
+	rec[0] = MEM_STATS_MAGIC0;
+	rec[1] = MEM_STATS_MAGIC1;
+	rec[2] = 1 + 4*MEM_STATS_WORDS;
+
+	*p++ = region;
+	sum = region;
+
+	for(i = 0;i < MEM_STATS_WORDS;i++)
 	{
-		return 0xFFFFFFFF;
+		for(j = 0;j < 4;j++)
+		{
+			*p = (word[i] >> (8*j)) & 0xFF;
+			sum += *p++;
+		}
 	}
 
-	nmemb = size/memblksize;
-	if(size%memblksize)
+	*p++ = sum;
+
+	uart_write(rec, p - rec);
+
+	return 0;
+}
+
+
+// ********** Regions ********** //
+
+// Get local memory size
+static unsigned long mem_lm_size(unsigned long lm_cfg)
+{
+	unsigned long lmsz = (lm_cfg >> 15) & 0x1F;
+
+	if(!lmsz || lmsz > 20)
 	{
-		nmemb++;
+		return 0;	// Reserved size! treat as 0!
 	}
 
-	for(offset = memtblsize - 1;offset >= 0;offset--)
+	return 1UL << (9 + lmsz);
+}
+
+// Free memory of a region, the program image and the stack given by the linker script excluded
+static int mem_region_bounds(unsigned int region, unsigned long *start, unsigned long *end)
+{
+	unsigned long base, size;
+	unsigned long image_end = (unsigned long)&_end;
+	unsigned long stack_top = (unsigned long)&_stack;
+	unsigned long stack_bottom;
+
+	switch(region)
 	{
-		if(!malloc_dev.memmap[offset])
+	case MEM_REGION_DLM:
+		if(!(read_csr(NDS_MDLMB) & 0x1))
 		{
-			cmemb++;
+			return 0;
+		}
+		base = DLM_BASE;
+		size = mem_lm_size(read_csr(NDS_MDCM_CFG));
+		break;
+
+	case MEM_REGION_ILM:
+		if(!(read_csr(NDS_MILMB) & 0x1))
+		{
+			return 0;
+		}
+		base = ILM_BASE;
+		size = mem_lm_size(read_csr(NDS_MICM_CFG));
+		break;
+
+	case MEM_REGION_DDR:
+		base = DDRMEM_BASE;
+		size = MEM_DDR_SIZE;
+		break;
+
+	default:
+		return 0;
+	}
+
+	*start = base;
+	*end = base + size;
+
+	// The program image is linked from the bottom of its memory
+	if((image_end > *start) && (image_end <= *end))
+	{
+		*start = image_end;
+	}
+
+	// Keep the stack, then the larger side of it
+	if((stack_top > *start) && (stack_top <= *end))
+	{
+		stack_bottom = (stack_top - *start > MEM_STACK_SIZE) ? stack_top - MEM_STACK_SIZE : *start;
+
+		if(*end - stack_top > stack_bottom - *start)
+		{
+			*start = stack_top;
 		}
 		else
 		{
-			cmemb = 0;
+			*end = stack_bottom;
+		}
+	}
+
+	return (*end > *start) && (*end - *start > sizeof(mem_control_t) + 2*sizeof(mem_block_t));
+}
+
+// Get an initialized region, 0 if not available
+static struct _mem_region* mem_region_get(unsigned int region)
+{
+	struct _mem_region *rgn = &mem_region[region];
+	unsigned long start, end;
+
+	if(rgn->state == 0)
+	{
+		if(region == MEM_REGION_DEFAULT)
+		{
+			mem_init();
+		}
+		else if(mem_region_bounds(region, &start, &end))
+		{
+			// Region control at the region start, then the heap
+			rgn->control = (mem_control_t *)MEM_ALIGN_UP(start);
+			rgn->start = start;
+			rgn->end = end;
+
+			mem_control_init(rgn->control);
+			mem_pool_add(rgn->control, rgn->control + 1, end - (unsigned long)(rgn->control + 1));
+			rgn->state = 1;
+		}
+		else
+		{
+			rgn->state = 2;
+		}
+	}
+
+	return (rgn->state == 1) ? rgn : 0;
+}
+
+
+// ********** TLSF core ********** //
+
+// Find last set: index of the most significant bit set
+__attribute__((always_inline))
+static inline int mem_fls(unsigned long x)
+{
+	return x ? (int)(sizeof(unsigned long)*8 - 1) - __builtin_clzl(x) : -1;
+}
+
+// Find first set: index of the least significant bit set
+__attribute__((always_inline))
+static inline int mem_ffs(unsigned int x)
+{
+	return x ? __builtin_ctz(x) : -1;
+}
+
+__attribute__((always_inline))
+static inline unsigned long block_size(const mem_block_t *block)
+{
+	return block->size & ~MEM_BLOCK_FREE_BIT;
+}
+
+__attribute__((always_inline))
+static inline void block_set_size(mem_block_t *block, unsigned long size)
+{
+	block->size = size | (block->size & MEM_BLOCK_FREE_BIT);
+}
+
+__attribute__((always_inline))
+static inline int block_is_free(const mem_block_t *block)
+{
+	return (int)(block->size & MEM_BLOCK_FREE_BIT);
+}
+
+__attribute__((always_inline))
+static inline int block_is_last(const mem_block_t *block)
+{
+	return block_size(block) == 0;
+}
+
+__attribute__((always_inline))
+static inline void* block_to_ptr(const mem_block_t *block)
+{
+	return (void *)((unsigned long)block + MEM_BLOCK_HDR_SIZE);
+}
+
+__attribute__((always_inline))
+static inline mem_block_t* block_from_ptr(const void *ptr)
+{
+	return (mem_block_t *)((unsigned long)ptr - MEM_BLOCK_HDR_SIZE);
+}
+
+__attribute__((always_inline))
+static inline mem_block_t* block_next(const mem_block_t *block)
+{
+	return (mem_block_t *)((unsigned long)block_to_ptr(block) + block_size(block));
+}
+
+// Map a size to its list indexes
+static void mapping_insert(unsigned long size, int *fli, int *sli)
+{
+	int fl, sl;
+
+	if(size < MEM_SMALL_BLOCK_SIZE)
+	{
+		// Small blocks are linearly spread in the first class
+		fl = 0;
+		sl = (int)size / (MEM_SMALL_BLOCK_SIZE / MEM_SL_INDEX_COUNT);
+	}
+	else
+	{
+		fl = mem_fls(size);
+		sl = (int)(size >> (fl - MEM_SL_INDEX_COUNT_LOG2)) ^ (1 << MEM_SL_INDEX_COUNT_LOG2);
+		fl -= (MEM_FL_INDEX_SHIFT - 1);
+	}
+
+	*fli = fl;
+	*sli = sl;
+}
+
+// Map a request size to the first list whose blocks are all large enough
+static void mapping_search(unsigned long size, int *fli, int *sli)
+{
+	if(size >= MEM_SMALL_BLOCK_SIZE)
+	{
+		size += (1UL << (mem_fls(size) - MEM_SL_INDEX_COUNT_LOG2)) - 1;
+	}
+
+	mapping_insert(size, fli, sli);
+}
+
+// Find a non-empty list at or above the given indexes
+static mem_block_t* search_suitable_block(mem_control_t *control, int *fli, int *sli)
+{
+	int fl = *fli;
+	int sl;
+	unsigned int sl_map;
+	unsigned int fl_map;
+
+	// Search in the same first level class
+	sl_map = control->sl_bitmap[fl] & (~0U << *sli);
+	if(!sl_map)
+	{
+		// Then in the next non-empty first level class
+		fl_map = (fl + 1 < MEM_FL_INDEX_COUNT) ? (control->fl_bitmap & (~0U << (fl + 1))) : 0;
+		if(!fl_map)
+		{
+			return 0;
 		}
 
-		if(cmemb == nmemb)
+		fl = mem_ffs(fl_map);
+		*fli = fl;
+		sl_map = control->sl_bitmap[fl];
+	}
+
+	sl = mem_ffs(sl_map);
+	*sli = sl;
+
+	return control->blocks[fl][sl];
+}
+
+static void remove_free_block(mem_control_t *control, mem_block_t *block, int fl, int sl)
+{
+	mem_block_t *prev = block->prev_free;
+	mem_block_t *next = block->next_free;
+
+	next->prev_free = prev;
+	prev->next_free = next;
+	control->fragments--;
+
+	// Update the list head and the bitmaps if the list becomes empty
+	if(control->blocks[fl][sl] == block)
+	{
+		control->blocks[fl][sl] = next;
+
+		if(next == &control->null_block)
 		{
-			for(i = 0;i < nmemb;i++)
+			control->sl_bitmap[fl] &= ~(1U << sl);
+
+			if(!control->sl_bitmap[fl])
 			{
-				malloc_dev.memmap[offset+i] = nmemb;
+				control->fl_bitmap &= ~(1U << fl);
 			}
+		}
+	}
+}
+
+static void insert_free_block(mem_control_t *control, mem_block_t *block, int fl, int sl)
+{
+	mem_block_t *current = control->blocks[fl][sl];
+
+	block->next_free = current;
+	block->prev_free = &control->null_block;
+	current->prev_free = block;
+
+	control->blocks[fl][sl] = block;
+	control->fragments++;
+	control->fl_bitmap |= (1U << fl);
+	control->sl_bitmap[fl] |= (1U << sl);
+}
+
+static void block_remove(mem_control_t *control, mem_block_t *block)
+{
+	int fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	remove_free_block(control, block, fl, sl);
+}
+
+static void block_insert(mem_control_t *control, mem_block_t *block)
+{
+	int fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	insert_free_block(control, block, fl, sl);
+}
+
+// Split the block at size, return the remaining free block or 0 if too small to split
+static mem_block_t* block_split(mem_block_t *block, unsigned long size)
+{
+	mem_block_t *remaining;
+	unsigned long remain_size;
+
+	if(block_size(block) < size + sizeof(mem_block_t))
+	{
+		return 0;
+	}
+
+	remain_size = block_size(block) - size - MEM_BLOCK_HDR_SIZE;
+	block_set_size(block, size);
+
+	remaining = block_next(block);
+	remaining->prev_phys = block;
+	remaining->size = remain_size | MEM_BLOCK_FREE_BIT;
+	block_next(remaining)->prev_phys = remaining;
+
+	return remaining;
+}
+
+// Absorb the next physical block into the block
+static mem_block_t* block_absorb(mem_block_t *prev, mem_block_t *block)
+{
+	block_set_size(prev, block_size(prev) + block_size(block) + MEM_BLOCK_HDR_SIZE);
+	block_next(prev)->prev_phys = prev;
+
+	return prev;
+}
+
+// Initialize the allocator control with empty lists
+static void mem_control_init(mem_control_t *control)
+{
+	int i, j;
+
+	control->null_block.next_free = &control->null_block;
+	control->null_block.prev_free = &control->null_block;
 
-			return (offset*memblksize);
+	control->fl_bitmap = 0;
+	for(i = 0;i < MEM_FL_INDEX_COUNT;i++)
+	{
+		control->sl_bitmap[i] = 0;
+		for(j = 0;j < MEM_SL_INDEX_COUNT;j++)
+		{
+			control->blocks[i][j] = &control->null_block;
 		}
 	}
 
-	return 0xFFFFFFFF;
+	control->total = 0;
+	control->used = 0;
+	control->peak = 0;
+	control->fragments = 0;
+	control->fail = 0;
+	control->moves = 0;
 }
 
-// Free
-static unsigned char my_free(unsigned int offset)
+// Hand a memory area to the allocator as one free block followed by a sentinel
+static void mem_pool_add(mem_control_t *control, void *mem, unsigned long bytes)
 {
-	int i;
+	unsigned long start = MEM_ALIGN_UP((unsigned long)mem);
+	unsigned long size;
+	mem_block_t *block;
+	mem_block_t *sentinel;
 
-	if(!malloc_dev.memrdy)
+	bytes -= start - (unsigned long)mem;
+	if(bytes < 2*MEM_BLOCK_HDR_SIZE + MEM_BLOCK_SIZE_MIN)
 	{
-		malloc_dev.init();
-		return 1;
+		return;
+	}
+
+	size = MEM_ALIGN_DOWN(bytes - 2*MEM_BLOCK_HDR_SIZE);
+	if(size > MEM_BLOCK_SIZE_MAX - MEM_ALIGN_SIZE)
+	{
+		size = MEM_BLOCK_SIZE_MAX - MEM_ALIGN_SIZE;
+	}
+
+	block = (mem_block_t *)start;
+	block->prev_phys = 0;
+	block->size = size | MEM_BLOCK_FREE_BIT;
+	block_insert(control, block);
+	control->total += size;
+
+	// Zero size used block, stops coalescing at the end of the pool
+	sentinel = block_next(block);
+	sentinel->prev_phys = block;
+	sentinel->size = 0;
+}
+
+// Take a free block of at least size bytes out of the lists
+static mem_block_t* block_locate_free(mem_control_t *control, unsigned long size)
+{
+	mem_block_t *block;
+	int fl, sl;
+
+	mapping_search(size, &fl, &sl);
+	if(fl >= MEM_FL_INDEX_COUNT)
+	{
+		return 0;
+	}
+
+	block = search_suitable_block(control, &fl, &sl);
+	if(!block || (block == &control->null_block))
+	{
+		return 0;
+	}
+
+	remove_free_block(control, block, fl, sl);
+
+	return block;
+}
+
+// Give back the tail of a located block and mark it used
+static void* block_prepare_used(mem_control_t *control, mem_block_t *block, unsigned long size)
+{
+	mem_block_t *remaining = block_split(block, size);
+
+	if(remaining)
+	{
+		block_insert(control, remaining);
+	}
+
+	block->size &= ~MEM_BLOCK_FREE_BIT;
+
+	control->used += block_size(block);
+	if(control->used > control->peak)
+	{
+		control->peak = control->used;
+	}
+
+	return block_to_ptr(block);
+}
+
+// Payload size for a request, 0 if the request can never be satisfied
+static unsigned long block_adjust_size(unsigned int size)
+{
+	unsigned long adjust;
+
+	if((size == 0) || (size > MEM_BLOCK_SIZE_MAX - MEM_SMALL_BLOCK_SIZE))
+	{
+		return 0;
+	}
+
+	adjust = MEM_ALIGN_UP((unsigned long)size);
+
+	return (adjust < MEM_BLOCK_SIZE_MIN) ? MEM_BLOCK_SIZE_MIN : adjust;
+}
+
+static void* mem_pool_malloc(mem_control_t *control, unsigned int size)
+{
+	unsigned long adjust = block_adjust_size(size);
+	mem_block_t *block;
+
+	if(!adjust)
+	{
+		control->fail++;
+		return 0;
 	}
 
-	if(offset < memsize)
+	block = block_locate_free(control, adjust);
+	if(!block)
 	{
-		int index = offset/memblksize;
-		int nmemb = malloc_dev.memmap[index];
+		control->fail++;
+		return 0;
+	}
+
+	return block_prepare_used(control, block, adjust);
+}
+
+// Allocate with the payload aligned on align bytes, align is a power of 2
+static void* mem_pool_memalign(mem_control_t *control, unsigned long align, unsigned int size)
+{
+	unsigned long adjust = block_adjust_size(size);
+	unsigned long ptr, aligned, gap;
+	mem_block_t *block;
+	mem_block_t *leading;
+
+	if(align <= MEM_ALIGN_SIZE)
+	{
+		return mem_pool_malloc(control, size);
+	}
+
+	if(!adjust)
+	{
+		return 0;
+	}
+
+	// Room to move the payload up to the alignment, leaving a valid free block in front
+	block = block_locate_free(control, adjust + align + sizeof(mem_block_t));
+	if(!block)
+	{
+		control->fail++;
+		return 0;
+	}
+
+	ptr = (unsigned long)block_to_ptr(block);
+	aligned = (ptr + align - 1) & ~(align - 1);
+	gap = aligned - ptr;
+
+	if(gap && (gap < sizeof(mem_block_t)))
+	{
+		aligned = (ptr + sizeof(mem_block_t) + align - 1) & ~(align - 1);
+		gap = aligned - ptr;
+	}
+
+	// Return the leading gap as a free block
+	if(gap)
+	{
+		leading = block;
+		block = block_split(leading, gap - MEM_BLOCK_HDR_SIZE);
+		block_insert(control, leading);
+	}
+
+	return block_prepare_used(control, block, adjust);
+}
+
+static void mem_pool_free(mem_control_t *control, void *ptr)
+{
+	mem_block_t *block = block_from_ptr(ptr);
+	mem_block_t *prev;
+	mem_block_t *next;
+
+	// Double free
+	if(block_is_free(block))
+	{
+		return;
+	}
+
+	block->size |= MEM_BLOCK_FREE_BIT;
+	control->used -= block_size(block);
 
-		for(i = 0;i < nmemb;i++)
+	// Coalesce with the previous physical block
+	prev = block->prev_phys;
+	if(prev && block_is_free(prev))
+	{
+		block_remove(control, prev);
+		block = block_absorb(prev, block);
+	}
+
+	// Coalesce with the next physical block
+	next = block_next(block);
+	if(!block_is_last(next) && block_is_free(next))
+	{
+		block_remove(control, next);
+		block = block_absorb(block, next);
+	}
+
+	block_insert(control, block);
+}
+
+// Resize in place, returns 0 if the block has to move
+static void* mem_pool_realloc(mem_control_t *control, void *ptr, unsigned int size)
+{
+	mem_block_t *block = block_from_ptr(ptr);
+	mem_block_t *next = block_next(block);
+	mem_block_t *remaining;
+	unsigned long adjust = block_adjust_size(size);
+	unsigned long old_size = block_size(block);
+
+	if(!adjust || block_is_free(block))
+	{
+		return 0;
+	}
+
+	if(adjust > old_size)
+	{
+		// Grow over the next physical block if it is free and large enough
+		if(block_is_last(next) || !block_is_free(next) || (old_size + MEM_BLOCK_HDR_SIZE + block_size(next) < adjust))
 		{
-			malloc_dev.memmap[index+i] = 0;
+			return 0;
 		}
 
-		return 0;
+		block_remove(control, next);
+		block_absorb(block, next);
 	}
-	else
+
+	// Give back the tail, merged with a free block following it
+	remaining = block_split(block, adjust);
+	if(remaining)
 	{
-		return 2;
+		next = block_next(remaining);
+		if(!block_is_last(next) && block_is_free(next))
+		{
+			block_remove(control, next);
+			block_absorb(remaining, next);
+		}
+
+		block_insert(control, remaining);
 	}
+
+	control->used += block_size(block) - old_size;
+	if(control->used > control->peak)
+	{
+		control->peak = control->used;
+	}
+
+	return ptr;
 }
@@ -11,11 +11,65 @@
 #define __MM_H__
 
 
+// Definitions ------------------------------------------------------------------------------
+
+#ifndef MEM_MAX_SIZE
+#define MEM_MAX_SIZE			8192		// Heap size in bytes, self-defined
+#endif
+
+#ifndef MEM_DDR_SIZE
+#define MEM_DDR_SIZE			0x08000000	// DDR managed by MEM_REGION_DDR, 128MB
+#endif
+
+#ifndef MEM_STACK_SIZE
+#define MEM_STACK_SIZE			0x10000		// Kept below _stack when the stack shares a region
+#endif
+
+#ifndef MEM_DMA_SIZE
+#define MEM_DMA_SIZE			0x10000		// DMA heap used by mem_malloc_dma()
+#endif
+
+#ifndef MEM_FL_INDEX_MAX
+#define MEM_FL_INDEX_MAX		28			// Largest block is 2^MEM_FL_INDEX_MAX bytes
+#endif
+
+
+// Heap regions, each one managed independently
+#define MEM_REGION_DEFAULT		0			// Static heap used by mem_malloc()
+#define MEM_REGION_DLM			1			// Data local memory, zero wait state, hot buffers
+#define MEM_REGION_ILM			2			// Instruction local memory
+#define MEM_REGION_DDR			3			// DDR, bulk buffers
+#define MEM_REGION_NUM			4
+#define MEM_REGION_DMA			MEM_REGION_NUM	// DMA heap of mem_malloc_dma(), statistics only
+
+// Or'ed to a region: DLM falls back to ILM, then the static heap, then DDR
+#define MEM_REGION_FALLBACK		0x80
+
+
+// Heap statistics
+typedef struct _mem_stats
+{
+	unsigned int total;					// Bytes managed
+	unsigned int used;					// Bytes in use
+	unsigned int peak;					// Peak bytes in use
+	unsigned int largest_free;			// Largest free block
+	unsigned int fragments;				// Free blocks
+	unsigned int fail;					// Failed allocations
+	unsigned int moves;					// Reallocations moving the data
+} mem_stats_t;
+
+
 // Declarations -----------------------------------------------------------------------------
 
 extern void mem_init(void);											// Initialize
 extern void* mem_malloc(unsigned int size);							// Allocate
-extern void mem_free(void *ptr);									// Free
+extern void* mem_malloc_region(unsigned int size, unsigned int region);	// Allocate in a region
+extern unsigned int mem_region_size(unsigned int region);			// Bytes managed by a region
+extern void* mem_malloc_dma(unsigned int size);						// Allocate a cache line aligned and padded DMA buffer
+extern void* mem_realloc(void *ptr, unsigned int size);				// Resize, in place when possible
+extern void mem_free(void *ptr);									// Free, any region
+extern int mem_stats(unsigned int region, mem_stats_t *stats);		// Heap statistics of a region or of MEM_REGION_DMA
+extern int mem_stats_send(unsigned int region);						// Send the statistics as a binary record by UART
 extern void mem_set(void *s, unsigned char c, unsigned int count);	// Set
 extern void mem_cpy(void *des, void *src, unsigned int n);			// Copy
 extern int mem_cmp(void *des, void *src, unsigned int n);			// Compare 1: not equal; 0: equal
@@ -0,0 +1,212 @@
+/*
+ * ******************************************************************************************
+ * File		: pool.c
+ * Author 	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Fixed-size object pools
+ * ******************************************************************************************
+ */
+
+/*
+ * Free objects are chained in a singly linked list through their first word.
+ *
+ * With the atomic extension, get pops the head with an LR/SC pair and put pushes with
+ * a compare and swap. An interrupt taken between the LR and the SC runs its own
+ * SC, which drops the interrupted reservation, so the interrupted SC fails and the
+ * sequence retries on the new head. This keeps the list consistent when objects are
+ * taken or returned from ISR context without masking interrupts.
+ *
+ * Without the atomic extension the list is updated with interrupts disabled.
+ */
+
+// Includes ---------------------------------------------------------------------------------
+#include "pool.h"
+#include "platform.h"
+
+
+// Definitions ------------------------------------------------------------------------------
+
+#if __riscv_xlen == 64
+#define POOL_LR		"lr.d"
+#define POOL_SC		"sc.d"
+#define POOL_LOAD	"ld"
+#else
+#define POOL_LR		"lr.w"
+#define POOL_SC		"sc.w"
+#define POOL_LOAD	"lw"
+#endif
+
+#ifdef __riscv_atomic
+
+// Pop the list head
+static inline mem_pool_node_t* pool_pop(mem_pool_node_t * volatile *head)
+{
+	mem_pool_node_t *node;
+	mem_pool_node_t *next;
+	unsigned long fail;
+
+	__asm__ volatile (
+		"1:	" POOL_LR "		%0, (%3)\n"
+		"	beqz	%0, 2f\n"
+		"	" POOL_LOAD "		%1, 0(%0)\n"
+		"	" POOL_SC "		%2, %1, (%3)\n"
+		"	bnez	%2, 1b\n"
+		"2:\n"
+		: "=&r"(node), "=&r"(next), "=&r"(fail)
+		: "r"(head)
+		: "memory");
+
+	return node;
+}
+
+// Push a node as the list head, a plain compare and swap is enough here
+static inline void pool_push(mem_pool_node_t * volatile *head, mem_pool_node_t *node)
+{
+	mem_pool_node_t *first = *head;
+
+	do
+	{
+		node->next = first;
+	} while(!__atomic_compare_exchange_n(head, &first, node, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// Count an object handed out and track the high-water mark
+static inline void pool_count_get(mem_pool_t *pool)
+{
+	unsigned int in_use = __atomic_add_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+
+	__asm__ volatile ("amomaxu.w zero, %1, (%0)" : : "r"(&pool->high_water), "r"(in_use) : "memory");
+}
+
+static inline void pool_count_put(mem_pool_t *pool)
+{
+	__atomic_sub_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+}
+
+static inline void pool_count_fail(mem_pool_t *pool)
+{
+	__atomic_add_fetch(&pool->fail, 1, __ATOMIC_RELAXED);
+}
+
+#else	/* __riscv_atomic */
+
+// Pop the list head
+static inline mem_pool_node_t* pool_pop(mem_pool_node_t * volatile *head)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+	mem_pool_node_t *node = *head;
+
+	if(node)
+	{
+		*head = node->next;
+	}
+
+	set_csr(NDS_MSTATUS, saved_mie);
+
+	return node;
+}
+
+// Push a node as the list head
+static inline void pool_push(mem_pool_node_t * volatile *head, mem_pool_node_t *node)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	node->next = *head;
+	*head = node;
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+// Count an object handed out and track the high-water mark
+static inline void pool_count_get(mem_pool_t *pool)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	if(++pool->in_use > pool->high_water)
+	{
+		pool->high_water = pool->in_use;
+	}
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+static inline void pool_count_put(mem_pool_t *pool)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	pool->in_use--;
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+static inline void pool_count_fail(mem_pool_t *pool)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	pool->fail++;
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+#endif	/* __riscv_atomic */
+
+
+// Initialize
+void mem_pool_init(mem_pool_t *pool, void *mem, unsigned int obj_size, unsigned int obj_count)
+{
+	pool->base = mem;
+	pool->obj_size = MEM_POOL_OBJ_SIZE(obj_size);
+	pool->obj_count = obj_count;
+
+	mem_pool_reset(pool);
+}
+
+// Put back all objects and clear the counters, the pool must not be in use
+void mem_pool_reset(mem_pool_t *pool)
+{
+	mem_pool_node_t *node = 0;
+	unsigned int i = pool->obj_count;
+
+	// Chain from the end so that objects are handed out in address order
+	while(i--)
+	{
+		mem_pool_node_t *obj = (mem_pool_node_t *)(pool->base + i*pool->obj_size);
+
+		obj->next = node;
+		node = obj;
+	}
+
+	pool->free = node;
+	pool->in_use = 0;
+	pool->high_water = 0;
+	pool->fail = 0;
+}
+
+// Get an object, returns 0 when the pool is empty
+void* mem_pool_get(mem_pool_t *pool)
+{
+	mem_pool_node_t *node = pool_pop(&pool->free);
+
+	if(node)
+	{
+		pool_count_get(pool);
+	}
+	else
+	{
+		pool_count_fail(pool);
+	}
+
+	return node;
+}
+
+// Return an object
+void mem_pool_put(mem_pool_t *pool, void *obj)
+{
+	if(!obj)
+	{
+		return;
+	}
+
+	pool_push(&pool->free, (mem_pool_node_t *)obj);
+	pool_count_put(pool);
+}
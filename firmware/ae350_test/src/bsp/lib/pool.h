@@ -0,0 +1,50 @@
+/*
+ * ******************************************************************************************
+ * File		: pool.h
+ * Author 	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Fixed-size object pools
+ * ******************************************************************************************
+ */
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+
+// Definitions ------------------------------------------------------------------------------
+
+// Objects are at least one pointer and rounded up to 8 bytes
+#define MEM_POOL_OBJ_SIZE(size)		((((size) < sizeof(void *) ? sizeof(void *) : (size)) + 7) & ~7U)
+#define MEM_POOL_MEM_SIZE(size, count)	(MEM_POOL_OBJ_SIZE(size) * (count))
+
+// Define a pool and its storage, mem_pool_reset() must be called before the first use
+#define MEM_POOL_DEFINE(name, size, count)											\
+	static unsigned char name##_mem[MEM_POOL_MEM_SIZE(size, count)] __attribute__((aligned(8)));	\
+	mem_pool_t name = {0, name##_mem, MEM_POOL_OBJ_SIZE(size), (count), 0, 0, 0}
+
+typedef struct _mem_pool_node
+{
+	struct _mem_pool_node *next;
+} mem_pool_node_t;
+
+typedef struct _mem_pool
+{
+	mem_pool_node_t * volatile free;	// Free list head
+	unsigned char *base;				// Object storage
+	unsigned int obj_size;				// Object size in bytes
+	unsigned int obj_count;				// Number of objects
+	volatile unsigned int in_use;		// Objects currently handed out
+	volatile unsigned int high_water;	// Maximum of in_use since reset
+	volatile unsigned int fail;			// mem_pool_get() calls on an empty pool
+} mem_pool_t;
+
+
+// Declarations -----------------------------------------------------------------------------
+
+extern void mem_pool_init(mem_pool_t *pool, void *mem, unsigned int obj_size, unsigned int obj_count);	// Initialize
+extern void mem_pool_reset(mem_pool_t *pool);							// Put back all objects, clear counters
+extern void* mem_pool_get(mem_pool_t *pool);							// Get an object, ISR safe
+extern void mem_pool_put(mem_pool_t *pool, void *obj);					// Return an object, ISR safe
+
+
+#endif	/* __POOL_H__ */
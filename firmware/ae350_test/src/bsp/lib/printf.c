@@ -9,37 +9,62 @@
 
 /*
  ********************************************************************************************
- * putchar is the only external dependency for this file,
- * if you have a working putchar, leave it commented out.
- * If not, uncomment the define below and
- * replace outbyte(c) by your own function call.
+ * uart_write() is the only external dependency for this file.
+ *
+ * The formatter keeps all of its state in a print_out_t on the caller stack, so it is
+ * reentrant. printf() formats into a stack buffer and sends the line with one
+ * uart_write() call, a full buffer is sent and reused. A line from an interrupt
+ * handler is queued before or after a line of the main loop that fits in
+ * PRINTF_BUF_SIZE, never inside it. A longer line is sent by several uart_write()
+ * calls and may have the output of an interrupt handler in between.
+ * The string functions never write more than the given size.
  ********************************************************************************************
  */
 
-// Defined in uart.h and uart.c
-#define putchar(c) outbyte(c)
-
 #include <stdarg.h>
+#include "uart.h"
+
+// Stack buffer of printf(), lines up to this size are sent in one piece
+#ifndef PRINTF_BUF_SIZE
+#define PRINTF_BUF_SIZE 128
+#endif
 
-static void printchar(char **str, int c)
+typedef struct
 {
-	extern int putchar(int c);
+	char *buf;				// Output buffer
+	unsigned int size;		// Buffer size
+	unsigned int len;		// Characters in the buffer
+	int console;			// Send to the UART when full, '\r' after '\n'
+} print_out_t;
 
-	if (str)
+static void printchar(print_out_t *out, int c)
+{
+	if (out->console)
 	{
-		**str = c;
-		++(*str);
+		if (out->len + 2 > out->size)
+		{
+			uart_write(out->buf, out->len);
+			out->len = 0;
+		}
+
+		out->buf[out->len++] = c;
+
+		if (c == '\n')
+		{
+			out->buf[out->len++] = '\r';
+		}
 	}
-	else
+	else if (out->len + 1 < out->size)
 	{
-		(void)putchar(c);
+		// Keep the last byte for the terminating '\0'
+		out->buf[out->len++] = c;
 	}
 }
 
 #define PAD_RIGHT 1
 #define PAD_ZERO 2
 
-static int prints(char **out, const char *string, int width, int pad)
+static int prints(print_out_t *out, const char *string, int width, int pad)
 {
 	register int pc = 0, padchar = ' ';
 
@@ -92,43 +117,120 @@ static int prints(char **out, const char *string, int width, int pad)
 	return pc;
 }
 
-/* The following should be enough for 32 bit integer */
-#define PRINT_BUF_LEN 12
+/* The following should be enough for 64 bit integer */
+#define PRINT_BUF_LEN 24
+
+/*
+ * Decimal conversion takes two digits per step from a table. The quotient by 100 is
+ * a multiply by the reciprocal 2^37 / 100 (one mulhu on RV32), exact for every
+ * 32-bit value. 64-bit values are first split into 9-digit parts, which costs at
+ * most two 64-bit divisions. Hexadecimal only shifts and masks.
+ */
+static const char digits100[200] =
+	"00010203040506070809101112131415161718192021222324"
+	"25262728293031323334353637383940414243444546474849"
+	"50515253545556575859606162636465666768697071727374"
+	"75767778798081828384858687888990919293949596979899";
+
+#define DIV100(u)	((unsigned int)(((unsigned long long)(u) * 0x51EB851FU) >> 37))
 
-static int printi(char **out, int i, int b, int sg, int width, int pad, int letbase)
+// Decimal digits of a 32-bit value in front of s
+static char *utoa10(char *s, unsigned int u)
 {
-	char print_buf[PRINT_BUF_LEN];
-	register char *s;
-	register int t, neg = 0, pc = 0;
-	register unsigned int u = i;
+	register unsigned int q;
+	register const char *d;
 
-	if (i == 0)
+	while (u >= 100)
 	{
-		print_buf[0] = '0';
-		print_buf[1] = '\0';
+		q = DIV100(u);
+		d = &digits100[2 * (u - q * 100)];
+		*--s = d[1];
+		*--s = d[0];
+		u = q;
+	}
 
-		return prints (out, print_buf, width, pad);
+	if (u >= 10)
+	{
+		d = &digits100[2 * u];
+		*--s = d[1];
+		*--s = d[0];
 	}
+	else
+	{
+		*--s = u + '0';
+	}
+
+	return s;
+}
+
+// Decimal digits of a 64-bit value in front of s
+static char *ulltoa10(char *s, unsigned long long u)
+{
+	unsigned long long q;
+	char *e;
 
-	if (sg && b == 10 && i < 0)
+	while (u >> 32)
 	{
-		neg = 1;
-		u = -i;
+		q = u / 1000000000U;
+		e = s - 9;
+		s = utoa10(s, (unsigned int)(u - q * 1000000000U));
+
+		// Leading zeros of the 9-digit part
+		while (s > e)
+		{
+			*--s = '0';
+		}
+
+		u = q;
 	}
 
-	s = print_buf + PRINT_BUF_LEN-1;
-	*s = '\0';
+	return utoa10(s, (unsigned int)u);
+}
+
+// Hexadecimal digits of a 64-bit value in front of s
+static char *ulltoa16(char *s, unsigned long long u, int letbase)
+{
+	register const char *d = (letbase == 'a') ? "0123456789abcdef" : "0123456789ABCDEF";
+	register unsigned int w = (unsigned int)u;
+	register unsigned int hi = (unsigned int)(u >> 32);
+	register int n;
 
-	while (u)
+	if (hi)
 	{
-		t = u % b;
-		if( t >= 10 )
+		for (n = 0; n < 8; n++)
 		{
-			t += letbase - '0' - 10;
+			*--s = d[w & 0xF];
+			w >>= 4;
 		}
 
-		*--s = t + '0';
-		u /= b;
+		w = hi;
+	}
+
+	do
+	{
+		*--s = d[w & 0xF];
+		w >>= 4;
+	} while (w);
+
+	return s;
+}
+
+static int printi(print_out_t *out, unsigned long long u, int b, int neg, int width, int pad, int letbase)
+{
+	char print_buf[PRINT_BUF_LEN];
+	register char *s;
+	register int pc = 0;
+
+	s = print_buf + PRINT_BUF_LEN-1;
+	*s = '\0';
+
+	if (b == 10)
+	{
+		s = (u >> 32) ? ulltoa10(s, u) : utoa10(s, (unsigned int)u);
+	}
+	else
+	{
+		s = ulltoa16(s, u, letbase);
 	}
 
 	if (neg)
@@ -148,10 +250,18 @@ static int printi(char **out, int i, int b, int sg, int width, int pad, int letb
 	return pc + prints (out, s, width, pad);
 }
 
-static int print( char **out, const char *format, va_list args )
+// Signed argument of the length modifier, 0: int; 1: long; 2: long long
+#define VA_SIGNED(args, lng)	((lng) >= 2 ? va_arg(args, long long) : (lng) ? va_arg(args, long) : va_arg(args, int))
+
+// Unsigned argument of the length modifier
+#define VA_UNSIGNED(args, lng)	((lng) >= 2 ? va_arg(args, unsigned long long) : \
+								 (lng) ? va_arg(args, unsigned long) : va_arg(args, unsigned int))
+
+static int print( print_out_t *out, const char *format, va_list args )
 {
-	register int width, pad;
+	register int width, pad, lng;
 	register int pc = 0;
+	long long v;
 	char scr[2];
 
 	for (; *format != 0; ++format)
@@ -189,34 +299,55 @@ static int print( char **out, const char *format, va_list args )
 				width += *format - '0';
 			}
 
+			// Length modifier, 'h' and 'hh' are promoted to int
+			for (lng = 0; *format == 'l'; ++format)
+			{
+				++lng;
+			}
+
+			while (*format == 'h')
+			{
+				++format;
+			}
+
 			if( *format == 's' )
 			{
-				register char *s = (char *)((long)va_arg( args, int ));
+				register char *s = va_arg( args, char * );
 				pc += prints (out, s?s:"(null)", width, pad);
 				continue;
 			}
 
-			if( *format == 'd' )
+			if( *format == 'd' || *format == 'i' )
 			{
-				pc += printi (out, va_arg( args, int ), 10, 1, width, pad, 'a');
+				v = VA_SIGNED( args, lng );
+				pc += printi (out, (v < 0) ? -(unsigned long long)v : (unsigned long long)v, 10, v < 0, width, pad, 'a');
 				continue;
 			}
 
 			if( *format == 'x' )
 			{
-				pc += printi (out, va_arg( args, int ), 16, 0, width, pad, 'a');
+				pc += printi (out, VA_UNSIGNED( args, lng ), 16, 0, width, pad, 'a');
 				continue;
 			}
 
 			if( *format == 'X' )
 			{
-				pc += printi (out, va_arg( args, int ), 16, 0, width, pad, 'A');
+				pc += printi (out, VA_UNSIGNED( args, lng ), 16, 0, width, pad, 'A');
 				continue;
 			}
 
 			if( *format == 'u' )
 			{
-				pc += printi (out, va_arg( args, int ), 10, 0, width, pad, 'a');
+				pc += printi (out, VA_UNSIGNED( args, lng ), 10, 0, width, pad, 'a');
+				continue;
+			}
+
+			if( *format == 'p' )
+			{
+				/* 0x and all digits of the pointer */
+				printchar (out, '0');
+				printchar (out, 'x');
+				pc += 2 + printi (out, (unsigned long)va_arg( args, void * ), 16, 0, 2 * sizeof(void *), PAD_ZERO, 'a');
 				continue;
 			}
 
@@ -237,41 +368,69 @@ static int print( char **out, const char *format, va_list args )
 		}
 	}
 
-	if (out)
+	if (out->console)
+	{
+		if (out->len)
+		{
+			uart_write(out->buf, out->len);
+		}
+	}
+	else if (out->size)
 	{
-		**out = '\0';
+		out->buf[out->len] = '\0';
 	}
 
-	va_end( args );
-
 	return pc;
 }
 
+int vprintf(const char *format, va_list args)
+{
+	char line[PRINTF_BUF_SIZE];
+	print_out_t out = {line, PRINTF_BUF_SIZE, 0, 1};
+
+	return print( &out, format, args );
+}
+
 int printf(const char *format, ...)
 {
-    va_list args;
+	va_list args;
+	int pc;
+
+	va_start( args, format );
+	pc = vprintf( format, args );
+	va_end( args );
 
-    va_start( args, format );
+	return pc;
+}
+
+int vsnprintf(char *buf, unsigned int count, const char *format, va_list args)
+{
+	print_out_t out = {buf, count, 0, 0};
 
-    return print( 0, format, args );
+	return print( &out, format, args );
 }
 
-int sprintf(char *out, const char *format, ...)
+int snprintf(char *buf, unsigned int count, const char *format, ...)
 {
-    va_list args;
+	va_list args;
+	int pc;
 
-    va_start( args, format );
+	va_start( args, format );
+	pc = vsnprintf( buf, count, format, args );
+	va_end( args );
 
-    return print( &out, format, args );
+	return pc;
 }
 
-int snprintf( char *buf, unsigned int count, const char *format, ... )
+// Unbounded, use snprintf() when the output size is not known
+int sprintf(char *out, const char *format, ...)
 {
-    va_list args;
-
-    ( void ) count;
+	va_list args;
+	int pc;
 
-    va_start( args, format );
+	va_start( args, format );
+	pc = vsnprintf( out, ~0U >> 1, format, args );
+	va_end( args );
 
-    return print( &buf, format, args );
+	return pc;
 }
@@ -15,22 +15,37 @@
 
 /*
  * Retarget function for scanf()
+ *
+ * Waits for the first character, then takes the characters already received in
+ * chunks until the end of the line ('\r') or len. Characters after the '\r' stay
+ * in the stdin buffer for the next read.
  */
 extern int _read (int file, char * ptr, int len);
 int _read (int file, char * ptr, int len)
 {
-	char c;
+	int n = 0;
+	int got;
 	int i;
 
-	for (i = 0; i < len; i++)
+	while (n < len)
 	{
-		c = uart_getc();
-		*ptr++ = c;
-		if (c == '\r')
+		got = uart_read(ptr + n, len - n);
+
+		if (got == 0)
+		{
+			// Nothing ready, wait for the next character
+			ptr[n] = uart_getc();
+			got = 1;
+		}
+
+		for (i = n, n += got; i < n; i++)
 		{
-			break;
+			if (ptr[i] == '\r')
+			{
+				return n;
+			}
 		}
 	}
 
-	return (len - i);
+	return n;
 }
@@ -7,26 +7,408 @@
  * ******************************************************************************************
  */
 
+/*
+ * Console output goes through a TX ring buffer. uart_putc() only queues the character;
+ * the ring is drained in the background by the UART TX DMA handshake or by the THR
+ * empty interrupt, so printf() no longer waits for the line to be sent.
+ *
+ * With DMA, the running transfer and the next one are queued on the channel, so the
+ * DMA goes on with the next run of bytes while the callback of the previous one queues
+ * the rest. The bytes of the queued transfers stay in the ring until their terminal count
+ * callback, they are "in flight" and are never overwritten. When the channel is busy
+ * with another user, the queued bytes are sent by polling instead.
+ *
+ * The ring state is only changed with interrupts disabled, so printf() may be called
+ * from interrupt handlers. A full ring is handled by UART_TX_POLICY; UART_TX_BLOCK
+ * makes progress by itself when it is called with interrupts disabled.
+ *
+ * uart_flush() sends everything by polling and waits for the transmitter to be empty,
+ * call it before a reset or from a crash handler.
+ *
+ * Input goes through an RX ring buffer filled by the receive data available and
+ * character timeout interrupts, the RX FIFO triggers at 8 characters. Reading with
+ * interrupts disabled first moves what the FIFO holds to the ring.
+ *
+ * With the RX ring or the THRE drain, the console owns the UART interrupt after
+ * uart_init(). Before that the interrupt goes to the UART driver.
+ */
+
 // Includes ---------------------------------------------------------------------------------
 #include "uart.h"
 #include "platform.h"
 
+#include "uart_ae350.h"
+
 
 // Definitions ------------------------------------------------------------------------------
 
 // Define UART1 or UART2 used in printf()
 #if UART1_USED_IN_PRINTF
-#define	DEV_UART	DEV_UART1	// UART1
+#define	DEV_UART			DEV_UART1				// UART1
+#define UART_IRQ_SOURCE		IRQ_UART1_SOURCE
+#define UART_IRQ_HANDLER	uart1_irq_handler
+#define UART_DRIVER_IRQ		uart1_driver_irq_handler
+#define UART_DMA_TX_EN		DRV_UART1_DMA_TX_EN
+#define UART_DMA_TX_REQID	DRV_UART1_DMA_TX_REQID
 #else
-#define	DEV_UART	DEV_UART2	// UART2
+#define	DEV_UART			DEV_UART2				// UART2
+#define UART_IRQ_SOURCE		IRQ_UART2_SOURCE
+#define UART_IRQ_HANDLER	uart2_irq_handler
+#define UART_DRIVER_IRQ		uart2_driver_irq_handler
+#define UART_DMA_TX_EN		DRV_UART2_DMA_TX_EN
+#define UART_DMA_TX_REQID	DRV_UART2_DMA_TX_REQID
 #endif
 
 // Baud rate computed
 #define BAUD_RATE(n)            ((UCLKFREQ + 8 * (n)) / (16 * (n)))
 
+#define SERIAL_LSR_RDR		0x01		// Data ready
+#define SERIAL_LSR_OE		0x02		// Overrun error
+#define SERIAL_LSR_THRE		0x20		// THR empty
+#define SERIAL_LSR_TEMT		0x40		// Transmitter empty
+#define SERIAL_IER_RDR		0x01		// Data ready and character timeout interrupt enable
+#define SERIAL_IER_THRE		0x02		// THR empty interrupt enable
+#define SERIAL_FCR_DMA		0x08		// DMA mode
+#define SERIAL_FCR_RX_TRGL8	0x80		// RX FIFO interrupt trigger level 8
+
+// FIFO depth from the hardware configure register
+#define SERIAL_FIFO_DEPTH	(16U << (DEV_UART->CFG & 0x3))
+
+#if UART_TX_BUF_SIZE && (UART_TX_DRAIN == UART_TX_DRAIN_DMA) && UART_DMA_TX_EN
+#define UART_TX_USE_DMA		1
+#else
+#define UART_TX_USE_DMA		0
+#endif
+
+// The console owns the UART interrupt
+#if UART_RX_BUF_SIZE || (UART_TX_BUF_SIZE && !UART_TX_USE_DMA)
+#define UART_USE_IRQ		1
+#else
+#define UART_USE_IRQ		0
+#endif
+
+#if UART_TX_BUF_SIZE
+
+#if (UART_TX_BUF_SIZE & (UART_TX_BUF_SIZE - 1))
+#error "UART_TX_BUF_SIZE must be a power of 2"
+#endif
+
+#define TX_MASK				(UART_TX_BUF_SIZE - 1)
+
+// Transfers queued on the DMA channel, the running one and the next
+#define TX_DMA_QUEUE		2
+#define TX_PENDING()		(uart_tx.head - uart_tx.tail)
+#define TX_FULL()			(TX_PENDING() >= UART_TX_BUF_SIZE)
+
+// Indexes are free running, only masked to access the buffer
+static struct _uart_tx
+{
+	volatile unsigned int head;			// Next character queued
+	volatile unsigned int tail;			// Oldest character not yet sent
+	volatile unsigned int busy;			// Characters from tail in the queued DMA transfers
+	volatile unsigned int dma;			// DMA transfers queued, callback not run yet
+	unsigned int dma_ch;				// Channel of dma_channel_request(), DMA_CHANNEL_ANY for polled output
+#if UART_TX_USE_DMA
+	unsigned int xfer_next;				// Next of xfer[] to queue, they complete in order
+	DMA_XFER xfer[TX_DMA_QUEUE];
+#endif
+	unsigned int init;
+	uart_tx_stats_t stats;
+	unsigned char buf[UART_TX_BUF_SIZE];
+} uart_tx;
+
+#if UART_TX_USE_DMA
+static void uart_tx_dma_event(DMA_XFER *xfer, uint32_t event);
+#endif
+
+// Send a character by polling
+static inline void tx_send_polled(int c)
+{
+	while ((DEV_UART->LSR & SERIAL_LSR_THRE) == 0);
+
+	DEV_UART->THR = c;
+}
+
+// Release the characters of the DMA transfers that the hardware has finished
+static inline void tx_reap(void)
+{
+#if UART_TX_USE_DMA
+	if(uart_tx.dma)
+	{
+		// Runs the callback of a finished transfer
+		dma_channel_poll(uart_tx.dma_ch);
+	}
+#endif
+}
+
+// Start draining the ring, interrupts disabled
+static void tx_kick(void)
+{
+	if(uart_tx.head == uart_tx.tail)
+	{
+		return;
+	}
+
+#if UART_TX_USE_DMA
+	unsigned int start;
+	unsigned int len;
+	DMA_XFER *xfer;
+
+	// The callback of a transfer queues what came in meanwhile
+	while(uart_tx.dma < TX_DMA_QUEUE)
+	{
+		// One contiguous run after the queued ones, the wrapped part goes with the next transfer
+		start = (uart_tx.tail + uart_tx.busy) & TX_MASK;
+		len = TX_PENDING() - uart_tx.busy;
+
+		if(len == 0)
+		{
+			return;
+		}
+
+		if(start + len > UART_TX_BUF_SIZE)
+		{
+			len = UART_TX_BUF_SIZE - start;
+		}
+
+		xfer = &uart_tx.xfer[uart_tx.xfer_next % TX_DMA_QUEUE];
+		xfer->src_addr = (uint32_t)&uart_tx.buf[start];
+		xfer->dst_addr = (uint32_t)&DEV_UART->THR;
+		xfer->size     = len;
+		xfer->control  = DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+						 DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+						 DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
+						 DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
+						 DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE) |
+						 DMA_CH_CTRL_DMODE_HANDSHAKE |
+						 DMA_CH_CTRL_SRCADDR_INC |
+						 DMA_CH_CTRL_DSTADDR_FIX |
+						 DMA_CH_CTRL_DSTREQ(UART_DMA_TX_REQID) |
+						 DMA_CH_CTRL_INTABT |
+						 DMA_CH_CTRL_INTERR |
+						 DMA_CH_CTRL_INTTC;
+		xfer->cb_event = uart_tx_dma_event;
+
+		if(dma_channel_submit(uart_tx.dma_ch, xfer) != 0)
+		{
+			break;
+		}
+
+		uart_tx.xfer_next++;
+		uart_tx.busy += len;
+		uart_tx.dma++;
+	}
+
+	if(uart_tx.dma)
+	{
+		return;
+	}
+
+	// Channel taken by another user, keep the output going
+	while(uart_tx.tail != uart_tx.head)
+	{
+		tx_send_polled(uart_tx.buf[uart_tx.tail & TX_MASK]);
+		uart_tx.tail++;
+	}
+#else
+	DEV_UART->IER |= SERIAL_IER_THRE;
+#endif
+}
+
+#if UART_TX_USE_DMA
+
+// DMA callback, error and abort also release the transfer
+static void uart_tx_dma_event(DMA_XFER *xfer, uint32_t event)
+{
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	uart_tx.tail += xfer->size;
+	uart_tx.busy -= xfer->size;
+	uart_tx.dma--;
+
+	tx_kick();
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+#else
+
+// Refill the TX FIFO, interrupts disabled
+static inline void tx_irq(void)
+{
+	unsigned int n;
+
+	if(DEV_UART->LSR & SERIAL_LSR_THRE)
+	{
+		for(n = SERIAL_FIFO_DEPTH; n && uart_tx.tail != uart_tx.head; n--)
+		{
+			DEV_UART->THR = uart_tx.buf[uart_tx.tail & TX_MASK];
+			uart_tx.tail++;
+		}
+	}
+
+	if(uart_tx.tail == uart_tx.head)
+	{
+		DEV_UART->IER &= ~SERIAL_IER_THRE;
+	}
+}
+
+#endif	/* UART_TX_USE_DMA */
+
+/*
+ * Make room for characters, interrupts disabled, returns 0 to drop the character.
+ * UART_TX_BLOCK waits for room for all need characters, the other policies make room
+ * for one character.
+ */
+static int tx_make_room(unsigned int need, unsigned long *saved_mie)
+{
+	tx_reap();
+
+#if UART_TX_POLICY == UART_TX_BLOCK
+	while(TX_PENDING() + need > UART_TX_BUF_SIZE)
+	{
+		if(uart_tx.busy == 0)
+		{
+			// Nothing in flight, send the oldest character here
+			tx_send_polled(uart_tx.buf[uart_tx.tail & TX_MASK]);
+			uart_tx.tail++;
+			continue;
+		}
+
+		// Let the callback run if the caller allows interrupts
+		set_csr(NDS_MSTATUS, *saved_mie);
+		*saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+		tx_reap();
+	}
+#elif UART_TX_POLICY == UART_TX_OVERWRITE_OLDEST
+	if(TX_FULL())
+	{
+		unsigned int first = uart_tx.tail + uart_tx.busy;
+		unsigned int queued = uart_tx.head - first;
+		unsigned int n = queued / 4 + 1;
+		unsigned int i;
+
+		if(queued == 0)
+		{
+			// All characters are in flight
+			uart_tx.stats.dropped++;
+			return 0;
+		}
+
+		if(n > queued)
+		{
+			n = queued;
+		}
+
+		// Drop the oldest queued characters in one go, the newer ones move down
+		for(i = first; i + n != uart_tx.head; i++)
+		{
+			uart_tx.buf[i & TX_MASK] = uart_tx.buf[(i + n) & TX_MASK];
+		}
+
+		uart_tx.head -= n;
+		uart_tx.stats.overwritten += n;
+	}
+#else
+	if(TX_FULL())
+	{
+		uart_tx.stats.dropped++;
+		return 0;
+	}
+#endif
+
+	return 1;
+}
+
+#endif	/* UART_TX_BUF_SIZE */
+
+#if UART_RX_BUF_SIZE
+
+#if (UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1))
+#error "UART_RX_BUF_SIZE must be a power of 2"
+#endif
+
+#define RX_MASK				(UART_RX_BUF_SIZE - 1)
+#define RX_PENDING()		(uart_rx.head - uart_rx.tail)
+
+// Indexes are free running, only masked to access the buffer
+static struct _uart_rx
+{
+	volatile unsigned int head;			// Next character received
+	volatile unsigned int tail;			// Oldest character not yet read
+	uart_rx_stats_t stats;
+	unsigned char buf[UART_RX_BUF_SIZE];
+} uart_rx;
+
+// Move the RX FIFO to the RX ring, interrupts disabled
+static void rx_irq(void)
+{
+	unsigned int lsr;
+	unsigned int c;
+
+	while((lsr = DEV_UART->LSR) & SERIAL_LSR_RDR)
+	{
+		c = DEV_UART->RBR;
+
+		if(lsr & SERIAL_LSR_OE)
+		{
+			uart_rx.stats.overrun++;
+		}
+
+		if(RX_PENDING() >= UART_RX_BUF_SIZE)
+		{
+			uart_rx.stats.overflow++;
+		}
+		else
+		{
+			uart_rx.buf[uart_rx.head & RX_MASK] = c;
+			uart_rx.head++;
+		}
+	}
+}
+
+#endif	/* UART_RX_BUF_SIZE */
+
+#if UART_USE_IRQ
+
+static unsigned int uart_irq_owned;
+
+// UART interrupt handler
+void UART_IRQ_HANDLER(void)
+{
+	unsigned long saved_mie;
+
+	if(!uart_irq_owned)
+	{
+		// uart_init() not called, the UART belongs to the driver
+		UART_DRIVER_IRQ();
+		return;
+	}
+
+	saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+#if UART_RX_BUF_SIZE
+	rx_irq();
+#endif
+
+#if UART_TX_BUF_SIZE && !UART_TX_USE_DMA
+	tx_irq();
+#endif
+
+	set_csr(NDS_MSTATUS, saved_mie);
+}
+
+#endif	/* UART_USE_IRQ */
+
 // Initializes UART
 void uart_init(unsigned int baudrate)
 {
+#if UART_TX_BUF_SIZE
+	// Send what is left with the old settings
+	uart_flush();
+#endif
+
 	/* Set DLAB to 1 */
 	DEV_UART->LCR |= 0x80;
 
@@ -38,27 +420,195 @@ void uart_init(unsigned int baudrate)
 	DEV_UART->LCR = 0x03;
 
 	/* FCR: enable FIFO, reset TX and RX. */
+#if UART_TX_USE_DMA && UART_RX_BUF_SIZE
+	DEV_UART->FCR = 0x07 | SERIAL_FCR_DMA | SERIAL_FCR_RX_TRGL8;
+#elif UART_TX_USE_DMA
+	DEV_UART->FCR = 0x07 | SERIAL_FCR_DMA;
+#elif UART_RX_BUF_SIZE
+	DEV_UART->FCR = 0x07 | SERIAL_FCR_RX_TRGL8;
+#else
 	DEV_UART->FCR = 0x07;
+#endif
+
+#if UART_TX_USE_DMA
+	if(!uart_tx.init)
+	{
+		int ch;
+
+		dma_initialize();
+
+		// No free channel, dma_channel_submit() refuses the transfers
+		ch = dma_channel_request(UART_TX_DMA_CH, DMA_PRIO_NORMAL);
+		uart_tx.dma_ch = (ch == -1) ? DMA_CHANNEL_ANY : ch;
+	}
+#endif
+
+#if UART_USE_IRQ
+	if(!uart_irq_owned)
+	{
+		// Priority must be set > 0 to trigger the interrupt
+		__nds__plic_set_priority(UART_IRQ_SOURCE, 1);
+
+		// Enable PLIC interrupt UART source
+		__nds__plic_enable_interrupt(UART_IRQ_SOURCE);
+
+		// Enable the Machine-External bit in MIE
+		set_csr(NDS_MIE, MIP_MEIP);
+
+		// Enable GIE
+		set_csr(NDS_MSTATUS, MSTATUS_MIE);
+
+		uart_irq_owned = 1;
+	}
+#endif
+
+#if UART_RX_BUF_SIZE
+	uart_rx.tail = uart_rx.head;
+	uart_rx.stats.overflow = 0;
+	uart_rx.stats.overrun = 0;
+
+	DEV_UART->IER |= SERIAL_IER_RDR;
+#endif
+
+#if UART_TX_BUF_SIZE
+	uart_tx.init = 1;
+
+	uart_tx.stats.high_water = 0;
+	uart_tx.stats.dropped = 0;
+	uart_tx.stats.overwritten = 0;
+#endif
 }
 
 // Input a character by UART
 int uart_getc(void)
 {
-	#define SERIAL_LSR_RDR 0x01
+#if UART_RX_BUF_SIZE
+	unsigned long saved_mie;
+	int c;
+
+	while(1)
+	{
+		saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
 
+		// Also works with interrupts disabled
+		rx_irq();
+
+		if(RX_PENDING())
+		{
+			c = uart_rx.buf[uart_rx.tail & RX_MASK];
+			uart_rx.tail++;
+
+			set_csr(NDS_MSTATUS, saved_mie);
+
+			return c;
+		}
+
+		set_csr(NDS_MSTATUS, saved_mie);
+	}
+#else
 	while ((DEV_UART->LSR & SERIAL_LSR_RDR) == 0);
 
 	return DEV_UART->RBR;
+#endif
+}
+
+// Characters ready to read, never blocks
+int uart_read_available(void)
+{
+#if UART_RX_BUF_SIZE
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+	int n;
+
+	rx_irq();
+	n = RX_PENDING();
+
+	set_csr(NDS_MSTATUS, saved_mie);
+
+	return n;
+#else
+	return (DEV_UART->LSR & SERIAL_LSR_RDR) ? 1 : 0;
+#endif
+}
+
+// Read the characters ready, up to len, never blocks
+int uart_read(void *buf, unsigned int len)
+{
+	unsigned char *p = buf;
+	unsigned int n = 0;
+#if UART_RX_BUF_SIZE
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	rx_irq();
+
+	while(n < len && RX_PENDING())
+	{
+		p[n++] = uart_rx.buf[uart_rx.tail & RX_MASK];
+		uart_rx.tail++;
+	}
+
+	set_csr(NDS_MSTATUS, saved_mie);
+#else
+	while(n < len && (DEV_UART->LSR & SERIAL_LSR_RDR))
+	{
+		p[n++] = DEV_UART->RBR;
+	}
+#endif
+
+	return n;
+}
+
+// RX ring statistics
+void uart_rx_stats(uart_rx_stats_t *stats)
+{
+#if UART_RX_BUF_SIZE
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	*stats = uart_rx.stats;
+	stats->pending = RX_PENDING();
+
+	set_csr(NDS_MSTATUS, saved_mie);
+#else
+	stats->pending = 0;
+	stats->overflow = 0;
+	stats->overrun = 0;
+#endif
 }
 
 // Print a character by UART
 void uart_putc(int c)
 {
-	#define SERIAL_LSR_THRE 0x20
+#if UART_TX_BUF_SIZE
+	unsigned long saved_mie;
+	unsigned int pending;
+
+	if(!uart_tx.init)
+	{
+		tx_send_polled(c);
+		return;
+	}
+
+	saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	if(!TX_FULL() || tx_make_room(1, &saved_mie))
+	{
+		uart_tx.buf[uart_tx.head & TX_MASK] = c;
+		uart_tx.head++;
+
+		pending = TX_PENDING();
+		if(pending > uart_tx.stats.high_water)
+		{
+			uart_tx.stats.high_water = pending;
+		}
 
+		tx_kick();
+	}
+
+	set_csr(NDS_MSTATUS, saved_mie);
+#else
 	while ((DEV_UART->LSR & SERIAL_LSR_THRE) == 0);
 
 	DEV_UART->THR = c;
+#endif
 }
 
 // Print a string by UART
@@ -94,3 +644,151 @@ int outbyte(int c)
 
 	return c;
 }
+
+/*
+ * Queue a block of bytes in one piece, returns the number of bytes queued. A block
+ * up to UART_TX_BUF_SIZE bytes is copied to the ring with interrupts disabled all along,
+ * UART_TX_BLOCK first waits for room for the whole block. A longer block is queued in
+ * pieces of the ring size, output of interrupt handlers may fall between them.
+ */
+int uart_write(const void *buf, unsigned int len)
+{
+	const unsigned char *p = buf;
+	unsigned int n = len;
+#if UART_TX_BUF_SIZE
+	unsigned long saved_mie;
+	unsigned int head;
+	unsigned int room;
+	unsigned int need;
+	unsigned int i;
+
+	if(!uart_tx.init)
+	{
+		while(n--)
+		{
+			tx_send_polled(*p++);
+		}
+
+		return len;
+	}
+
+	saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	while(n)
+	{
+#if UART_TX_POLICY == UART_TX_BLOCK
+		// Interrupts may run while waiting, never once the copy has started
+		need = (n < UART_TX_BUF_SIZE) ? n : UART_TX_BUF_SIZE;
+#else
+		need = 1;
+#endif
+
+		if(TX_PENDING() + need > UART_TX_BUF_SIZE)
+		{
+			// Start sending what is queued before waiting for room
+			tx_kick();
+
+			if(!tx_make_room(need, &saved_mie))
+			{
+				// The rest is dropped too, one was counted
+				uart_tx.stats.dropped += n - 1;
+				break;
+			}
+		}
+
+		// Copy up to the free space or the end of the buffer
+		head = uart_tx.head & TX_MASK;
+		room = UART_TX_BUF_SIZE - TX_PENDING();
+
+		if(room > UART_TX_BUF_SIZE - head)
+		{
+			room = UART_TX_BUF_SIZE - head;
+		}
+
+		if(room > n)
+		{
+			room = n;
+		}
+
+		for(i = 0;i < room;i++)
+		{
+			uart_tx.buf[head + i] = p[i];
+		}
+
+		uart_tx.head += room;
+		p += room;
+		n -= room;
+	}
+
+	if(TX_PENDING() > uart_tx.stats.high_water)
+	{
+		uart_tx.stats.high_water = TX_PENDING();
+	}
+
+	tx_kick();
+
+	set_csr(NDS_MSTATUS, saved_mie);
+
+	return len - n;
+#else
+	while(n--)
+	{
+		while ((DEV_UART->LSR & SERIAL_LSR_THRE) == 0);
+
+		DEV_UART->THR = *p++;
+	}
+
+	return len;
+#endif
+}
+
+// Send all buffered characters by polling and wait for the transmitter to be empty
+void uart_flush(void)
+{
+#if UART_TX_BUF_SIZE
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	if(uart_tx.init)
+	{
+#if UART_TX_USE_DMA
+		// The queued transfers complete here, their callbacks queue the rest of the ring
+		while(uart_tx.dma && dma_channel_get_status(uart_tx.dma_ch))
+		{
+			dma_channel_poll(uart_tx.dma_ch);
+		}
+#else
+		DEV_UART->IER &= ~SERIAL_IER_THRE;
+#endif
+
+		while(uart_tx.tail != uart_tx.head)
+		{
+			tx_send_polled(uart_tx.buf[uart_tx.tail & TX_MASK]);
+			uart_tx.tail++;
+		}
+	}
+#endif
+
+	while ((DEV_UART->LSR & SERIAL_LSR_TEMT) == 0);
+
+#if UART_TX_BUF_SIZE
+	set_csr(NDS_MSTATUS, saved_mie);
+#endif
+}
+
+// TX ring statistics
+void uart_tx_stats(uart_tx_stats_t *stats)
+{
+#if UART_TX_BUF_SIZE
+	unsigned long saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+	*stats = uart_tx.stats;
+	stats->pending = TX_PENDING();
+
+	set_csr(NDS_MSTATUS, saved_mie);
+#else
+	stats->pending = 0;
+	stats->high_water = 0;
+	stats->dropped = 0;
+	stats->overwritten = 0;
+#endif
+}
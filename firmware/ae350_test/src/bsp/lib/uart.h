@@ -15,6 +15,53 @@
 
 #define UART1_USED_IN_PRINTF  0		// UART1 used in printf(); otherwise UART2
 
+// Console TX ring buffer size in bytes, a power of 2; 0 for polled output
+#ifndef UART_TX_BUF_SIZE
+#define UART_TX_BUF_SIZE		1024
+#endif
+
+// TX ring drain, DMA falls back to the THRE interrupt when the UART has no DMA TX
+#define UART_TX_DRAIN_DMA		0		// UART TX DMA handshake
+#define UART_TX_DRAIN_IRQ		1		// UART THR empty interrupt
+
+#ifndef UART_TX_DRAIN
+#define UART_TX_DRAIN			UART_TX_DRAIN_DMA
+#endif
+
+// Preferred DMA channel to drain the TX ring, another free one when taken
+#ifndef UART_TX_DMA_CH
+#define UART_TX_DMA_CH			4
+#endif
+
+// Back-pressure policy when the TX ring is full
+#define UART_TX_BLOCK				0	// Wait for room
+#define UART_TX_DROP_NEWEST			1	// Drop the new character
+#define UART_TX_OVERWRITE_OLDEST	2	// Discard the oldest characters not yet handed to the UART
+
+#ifndef UART_TX_POLICY
+#define UART_TX_POLICY			UART_TX_BLOCK
+#endif
+
+// Console RX ring buffer size in bytes, a power of 2; 0 for polled input
+#ifndef UART_RX_BUF_SIZE
+#define UART_RX_BUF_SIZE		256
+#endif
+
+typedef struct _uart_tx_stats
+{
+	unsigned int pending;			// Characters in the TX ring
+	unsigned int high_water;		// Maximum of pending since uart_init()
+	unsigned int dropped;			// Characters dropped by UART_TX_DROP_NEWEST or a full ring
+	unsigned int overwritten;		// Characters discarded by UART_TX_OVERWRITE_OLDEST
+} uart_tx_stats_t;
+
+typedef struct _uart_rx_stats
+{
+	unsigned int pending;			// Characters in the RX ring
+	unsigned int overflow;			// Characters lost because the RX ring was full
+	unsigned int overrun;			// Overruns of the UART RX FIFO
+} uart_rx_stats_t;
+
 
 // Declarations ------------------------------------------------------------------------------
 
@@ -23,6 +70,12 @@ extern int uart_getc(void);							// Input a character by UART
 extern void uart_putc(int c);						// Print a character by UART
 extern int uart_puts(const char *s);				// Print a string by UART
 extern int outbyte(int c);							// Overwrite function for printf()
+extern int uart_write(const void *buf, unsigned int len);	// Queue a block of bytes in one piece
+extern void uart_flush(void);						// Send all buffered characters, usable with interrupts off
+extern void uart_tx_stats(uart_tx_stats_t *stats);	// TX ring statistics
+extern int uart_read_available(void);				// Characters ready to read, never blocks
+extern int uart_read(void *buf, unsigned int len);	// Read the characters ready, never blocks
+extern void uart_rx_stats(uart_rx_stats_t *stats);	// RX ring statistics
 
 
 #endif	/* __UART_H__ */
@@ -19,6 +19,14 @@
  * a global variable named g_selfmodify within D cache memory and use
  * fence.i instruction to do memory coherence. Final we check the
  * correctness of g_selfmodify to complete this demo.
+ *
+ * The D-cache maintenance of the DMA paths is then timed by 'mcycle' on
+ * dirty DDR buffers of 1KB to 1MB, write back and invalidate. Ranges from
+ * the size ae350_dcache_calibrate() set at boot take a whole D-Cache
+ * operation. The range operations of cache.c, write back, write back and
+ * invalidate, and invalidate, always go line by line; they are timed on the
+ * same buffers, and, when the CCTL begin address auto-increments, with the
+ * two CSR writes per line they took before.
  ********************************************************************************************
  */
 
@@ -31,7 +39,10 @@
 // ************ Includes ************ //
 #include "platform.h"
 #include "uart.h"
+#include "cache.h"
+#include "mm.h"
 #include <stdio.h>
+#include <string.h>
 
 
 // ********** Definitions ********** //
@@ -86,6 +97,9 @@
 
 #define BUF_SIZE                                0x100
 
+#define BENCH_CCTL_SIZE_MIN                     0x400
+#define BENCH_CCTL_SIZE_MAX                     0x100000
+
 
 typedef void (*fun_ptr)(void*);
 
@@ -342,6 +356,127 @@ void selfModifyCode(void)
 	fun((void*)&g_selfmodify);
 }
 
+/*
+ * The 'mcycle' counter is 64-bit counter. But RV32 access
+ * it as two 32-bit registers, so we check for rollover
+ * with this routine as suggested by the RISC-V Privileged
+ * Architecture Specification.
+ */
+__attribute__((always_inline))
+static inline unsigned long long rdmcycle(void)
+{
+#if __riscv_xlen == 32
+	do
+	{
+		unsigned long hi = read_csr(NDS_MCYCLEH);
+		unsigned long lo = read_csr(NDS_MCYCLE);
+
+		if (hi == read_csr(NDS_MCYCLEH))
+		{
+			return ((unsigned long long)hi << 32) | lo;
+		}
+	} while(1);
+#else
+	return read_csr(NDS_MCYCLE);
+#endif
+}
+
+// Time the D-cache range operations on dirty lines
+static void benchCctlRange(unsigned char *buf)
+{
+	unsigned long long t0, t1;
+	unsigned int wb, wbinval, inval;
+	unsigned long size;
+
+	for (size = BENCH_CCTL_SIZE_MIN; size <= BENCH_CCTL_SIZE_MAX; size <<= 2)
+	{
+		memset(buf, 0x5A, size);
+		t0 = rdmcycle();
+		ae350_dcache_writeback_range((unsigned long)buf, size);
+		t1 = rdmcycle();
+		wb = t1 - t0;
+
+		memset(buf, 0xA5, size);
+		t0 = rdmcycle();
+		ae350_dcache_flush_range((unsigned long)buf, size);
+		t1 = rdmcycle();
+		wbinval = t1 - t0;
+
+		memset(buf, 0x5A, size);
+		t0 = rdmcycle();
+		ae350_dcache_invalidate_range((unsigned long)buf, size);
+		t1 = rdmcycle();
+		inval = t1 - t0;
+
+		printf("  %7lu: write back %8u, flush %8u, invalidate %8u\r\n", size, wb, wbinval, inval);
+	}
+}
+
+// Time the D-cache maintenance of the DMA paths on dirty lines
+static void benchCctlDma(unsigned char *buf)
+{
+	unsigned long long t0, t1;
+	unsigned int wb, inval;
+	unsigned long size;
+
+	for (size = BENCH_CCTL_SIZE_MIN; size <= BENCH_CCTL_SIZE_MAX; size <<= 2)
+	{
+		memset(buf, 0x5A, size);
+		t0 = rdmcycle();
+		ae350_dma_writeback_range((unsigned long)buf, size);
+		t1 = rdmcycle();
+		wb = t1 - t0;
+
+		memset(buf, 0xA5, size);
+		t0 = rdmcycle();
+		ae350_dma_invalidate_range((unsigned long)buf, size);
+		t1 = rdmcycle();
+		inval = t1 - t0;
+
+		printf("  %7lu: write back %8u, invalidate %8u%s\r\n", size, wb, inval,
+				(cache_info.whole_size && (size >= cache_info.whole_size)) ? ", whole D-Cache" : "");
+	}
+}
+
+// Benchmark the CCTL range loops of cache.c
+void benchCctl(void)
+{
+	unsigned char *buf;
+
+	if (!cache_line_size() || !(read_csr(NDS_MMSC_CFG) & CCTLCSR_MSK))
+	{
+		return;
+	}
+
+	buf = mem_malloc_region(BENCH_CCTL_SIZE_MAX, MEM_REGION_DDR);
+	if (!buf)
+	{
+		printf("No DDR buffer for the CCTL benchmark.\r\n");
+		return;
+	}
+
+	printf("\r\nD-Cache %lu bytes, DMA whole D-Cache operations from %lu bytes\r\n",
+			cache_info.dset * cache_info.dway * cache_info.cacheline_size, cache_info.whole_size);
+
+	printf("\r\nCycles of the DMA D-Cache maintenance:\r\n");
+	benchCctlDma(buf);
+
+	printf("\r\nCycles of the D-Cache range operations, line by line, %s:\r\n",
+			cache_info.vcctl ? "auto-increment" : "address per line");
+	benchCctlRange(buf);
+
+	if (cache_info.vcctl)
+	{
+		// The loop of a core without auto-increment
+		cache_info.vcctl = 0;
+		printf("\r\nCycles of the D-Cache range operations, line by line, address per line:\r\n");
+		benchCctlRange(buf);
+		cache_info.vcctl = 1;
+	}
+
+	mem_free(buf);
+}
+
 // Application entry function
 int demo_cache(void)
 {
@@ -362,6 +497,8 @@ int demo_cache(void)
 			printf("Run selfModifyCode Fail.\r\n");
 		}
 
+		benchCctl();
+
 		printf("L1 Cache Completed.\r\n");
 	}
 
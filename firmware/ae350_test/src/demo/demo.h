@@ -40,6 +40,8 @@ extern "C" {
 #define RUN_DEMO_CACHE_LOCK		0	// Run L1 cache lock demo
 #define RUN_DEMO_IDLM			0	// Run access ILM/DLM demo
 #define RUN_DEMO_MM				0	// Run memory management demo
+#define RUN_DEMO_MM_BENCH		0	// Run memory management benchmark demo
+#define RUN_DEMO_DMA			0	// Run DMA copy benchmark demo
 #define RUN_DEMO_INTR			0	// Run multiple peripherals interrupts demo
 
 // Board feature demo
@@ -143,6 +145,16 @@ int demo_idlm(void);
 int demo_mm(void);
 #endif
 
+// Memory management benchmark demo
+#if RUN_DEMO_MM_BENCH
+int demo_mm_bench(void);
+#endif
+
+// DMA copy benchmark demo
+#if RUN_DEMO_DMA
+int demo_dma(void);
+#endif
+
 // Multiple peripherals interrupts demo
 #if RUN_DEMO_INTR
 int demo_intr(void);
@@ -0,0 +1,480 @@
+/*
+ * ******************************************************************************************
+ * File		: demo_dma.c
+ * Author	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: DMA copy benchmark demo
+ * ******************************************************************************************
+ */
+
+/*
+ ********************************************************************************************
+ * This demo compares the DMA copy service of dma_ae350.c with the CPU by 'mcycle'.
+ *
+ * Scenario:
+ *
+ * Buffers are taken from the DDR and the DLM heap regions. For each size, memcpy() and
+ * memset() of the C library are timed against dma_memcpy_async() and dma_memset_async()
+ * followed by dma_copy_wait(), for DDR to DDR, DDR to DLM and DLM to DDR. The DMA cycles
+ * include the cache maintenance. The cycles to start a DMA copy, the time the CPU is
+ * busy, are printed apart. Every copy is checked against the source.
+ *
+ * The AHB throughput of a DDR copy is then measured in bytes per 1000 cycles, once as a
+ * single block of bytes, the widths every transfer had before, and once as the chain of
+ * dma_channel_configure_auto() with the widths and bursts of the alignment. The copies
+ * are aligned, misaligned by the same offset, and misaligned by different offsets.
+ *
+ * A tile of a DDR frame is then copied to the DLM by dma_channel_configure_2d(), one
+ * descriptor per row, and every 8th word of the frame is gathered the same way. Both
+ * are timed against a CPU loop and checked.
+ *
+ * The DMA interrupt handler is then called with interrupts disabled, once the terminal
+ * counts of 1 up to all the free channels are pending, to time its dispatch by load.
+ *
+ * One copy is finally started with a completion callback and the CPU counts loops until
+ * the callback runs. The benchmark owns one channel of the allocator, the last copy
+ * requests a channel for itself only. The allocation statistics are printed at the end,
+ * with the cache maintenance the memory attributes skipped, e.g. for the DLM buffers.
+ * With CFG_DMA_STATS the telemetry of the benchmark channel is printed as well: its
+ * transfers, bytes and the completion latency by powers of 2 cycles.
+ ********************************************************************************************
+ */
+
+// Includes ---------------------------------------------------------------------------------
+#include "demo.h"
+
+// If running DMA copy benchmark demo
+#if RUN_DEMO_DMA
+
+// ************ Includes ************ //
+#include "platform.h"
+#include "uart.h"
+#include "mm.h"
+#include "dma_ae350.h"
+#include "cache.h"
+#include <stdio.h>
+#include <string.h>
+
+
+// ********** Definitions ********** //
+
+#define BENCH_DDR_SIZE_MAX		0x100000
+#define BENCH_DLM_SIZE_MAX		0x4000
+#define BENCH_IRQ_SIZE			64
+#define BENCH_WIDTH_SIZE		0x10000
+#define BENCH_FRAME_WIDTH		1024			// Bytes of a frame row
+#define BENCH_TILE_WIDTH		64
+#define BENCH_TILE_HEIGHT		64
+#define BENCH_2D_DESC			256
+
+// DMA interrupt handler of dma_ae350.c
+extern void dma_irq_handler(void);
+
+static DMA_COPY copy;
+static volatile unsigned int copy_done;
+static uint8_t copy_ch;							// Channel of the benchmark
+static DMA_LLP_DESC xfer_desc[DMA_XFER_DESC];	// Chain of the width benchmark
+static volatile uint32_t xfer_event;
+static DMA_LLP_DESC desc_2d[BENCH_2D_DESC];		// Rows of the 2D benchmark
+
+/*
+ * The 'mcycle' counter is 64-bit counter. But RV32 access
+ * it as two 32-bit registers, so we check for rollover
+ * with this routine as suggested by the RISC-V Privileged
+ * Architecture Specification.
+ */
+__attribute__((always_inline))
+static inline unsigned long long rdmcycle(void)
+{
+#if __riscv_xlen == 32
+	do
+	{
+		unsigned long hi = read_csr(NDS_MCYCLEH);
+		unsigned long lo = read_csr(NDS_MCYCLE);
+
+		if (hi == read_csr(NDS_MCYCLEH))
+		{
+			return ((unsigned long long)hi << 32) | lo;
+		}
+	} while(1);
+#else
+	return read_csr(NDS_MCYCLE);
+#endif
+}
+
+// Time one copy of each kind and check it
+static void bench_copy(const char *name, unsigned char *dst, unsigned char *src, unsigned int size)
+{
+	unsigned long long t0, t1, t2;
+	unsigned int cpu, start, dma;
+	unsigned int i;
+
+	for(i = 0;i < size;i++)
+	{
+		src[i] = i * 7 + 1;
+	}
+
+	t0 = rdmcycle();
+	memcpy(dst, src, size);
+	t1 = rdmcycle();
+	cpu = t1 - t0;
+
+	memset(dst, 0, size);
+
+	t0 = rdmcycle();
+	dma_memcpy_async(&copy, copy_ch, dst, src, size, NULL);
+	t1 = rdmcycle();
+	dma_copy_wait(&copy);
+	t2 = rdmcycle();
+	start = t1 - t0;
+	dma = t2 - t0;
+
+	printf("  %s memcpy %7u: CPU %8u, DMA %8u (start %6u) %s\r\n", name, size, cpu, dma, start,
+			(copy.status == DMA_COPY_DONE && !memcmp(dst, src, size)) ? "OK" : "ERROR");
+}
+
+// Time one fill of each kind and check it
+static void bench_set(const char *name, unsigned char *dst, unsigned int size)
+{
+	unsigned long long t0, t1, t2;
+	unsigned int cpu, start, dma;
+	unsigned int i;
+
+	t0 = rdmcycle();
+	memset(dst, 0xA5, size);
+	t1 = rdmcycle();
+	cpu = t1 - t0;
+
+	t0 = rdmcycle();
+	dma_memset_async(&copy, copy_ch, dst, 0x5A, size, NULL);
+	t1 = rdmcycle();
+	dma_copy_wait(&copy);
+	t2 = rdmcycle();
+	start = t1 - t0;
+	dma = t2 - t0;
+
+	for(i = 0;(i < size) && (dst[i] == 0x5A);i++);
+
+	printf("  %s memset %7u: CPU %8u, DMA %8u (start %6u) %s\r\n", name, size, cpu, dma, start,
+			(copy.status == DMA_COPY_DONE && i == size) ? "OK" : "ERROR");
+}
+
+// Channel callback of the width benchmark
+static void width_event(uint32_t event)
+{
+	xfer_event = event;
+}
+
+// Time one copy in bytes and one in the widths of the alignment, in bytes per 1000 cycles
+static void bench_width(const char *name, unsigned char *dst, unsigned char *src, unsigned int size)
+{
+	const uint32_t control = DMA_CH_CTRL_SBINF(DMA_INF_IDX1) |
+							 DMA_CH_CTRL_DBINF(DMA_INF_IDX1) |
+							 DMA_CH_CTRL_SRCADDR_INC |
+							 DMA_CH_CTRL_DSTADDR_INC |
+							 DMA_CH_CTRL_INTABT |
+							 DMA_CH_CTRL_INTERR |
+							 DMA_CH_CTRL_INTTC |
+							 DMA_CH_CTRL_ENABLE;
+	DMA_SG_ENTRY sg;
+	unsigned long long t0, t1;
+	unsigned int byte, best;
+	int ok;
+	unsigned int i;
+
+	for(i = 0;i < size;i++)
+	{
+		src[i] = i * 13 + 5;
+	}
+
+	memset(dst, 0, size);
+	xfer_event = 0;
+	t0 = rdmcycle();
+	sg.src_addr = (uint32_t)(long)src;
+	sg.dst_addr = (uint32_t)(long)dst;
+	sg.size     = size;
+	dma_llp_build(xfer_desc, &sg, 1, control |
+				  DMA_CH_CTRL_SBSIZE(DMA_BSIZE_1) |
+				  DMA_CH_CTRL_SWIDTH(DMA_WIDTH_BYTE) |
+				  DMA_CH_CTRL_DWIDTH(DMA_WIDTH_BYTE));
+	dma_channel_configure_llp(copy_ch, xfer_desc, width_event);
+	while(!xfer_event);
+	t1 = rdmcycle();
+	byte = t1 - t0;
+	ok = (xfer_event == DMA_EVENT_TERMINAL_COUNT_REQUEST) && !memcmp(dst, src, size);
+
+	memset(dst, 0, size);
+	xfer_event = 0;
+	t0 = rdmcycle();
+	dma_channel_configure_auto(copy_ch, xfer_desc, DMA_XFER_DESC, (uint32_t)(long)src, (uint32_t)(long)dst, size,
+							   control, width_event);
+	while(!xfer_event);
+	t1 = rdmcycle();
+	best = t1 - t0;
+	ok = ok && (xfer_event == DMA_EVENT_TERMINAL_COUNT_REQUEST) && !memcmp(dst, src, size);
+
+	printf("  %-8s %7u: bytes %8u (%5u B/kc), auto %8u (%5u B/kc) %s\r\n", name, size,
+			byte, (unsigned int)((unsigned long long)size * 1000 / byte),
+			best, (unsigned int)((unsigned long long)size * 1000 / best),
+			ok ? "OK" : "ERROR");
+}
+
+// Time one 2D copy against a CPU loop and check it
+static void bench_2d(const char *name, const DMA_2D *blk)
+{
+	unsigned char *src = (unsigned char *)(long)blk->src_addr;
+	unsigned char *dst = (unsigned char *)(long)blk->dst_addr;
+	unsigned long long t0, t1;
+	unsigned int cpu, dma;
+	unsigned int i;
+	int ok;
+
+	t0 = rdmcycle();
+	for(i = 0;i < blk->height;i++)
+	{
+		memcpy(dst + i * blk->dst_stride, src + i * blk->src_stride, blk->width);
+	}
+	t1 = rdmcycle();
+	cpu = t1 - t0;
+
+	for(i = 0;i < blk->height;i++)
+	{
+		memset(dst + i * blk->dst_stride, 0, blk->width);
+	}
+
+	xfer_event = 0;
+	t0 = rdmcycle();
+	dma_channel_configure_2d(copy_ch, desc_2d, BENCH_2D_DESC, blk, width_event);
+	while(!xfer_event);
+	t1 = rdmcycle();
+	dma = t1 - t0;
+
+	ok = (xfer_event == DMA_EVENT_TERMINAL_COUNT_REQUEST);
+	for(i = 0;ok && (i < blk->height);i++)
+	{
+		ok = !memcmp(dst + i * blk->dst_stride, src + i * blk->src_stride, blk->width);
+	}
+
+	printf("  %-8s %4ux%-4u: CPU %8u, DMA %8u %s\r\n", name, (unsigned int)blk->width, (unsigned int)blk->height,
+			cpu, dma, ok ? "OK" : "ERROR");
+}
+
+// Time the DMA interrupt handler with the terminal count of 1 to all free channels pending
+static void bench_irq(unsigned char *buf)
+{
+	static DMA_COPY irq_copy[DMA_NUMBER_OF_CHANNELS];
+	uint8_t ch[DMA_NUMBER_OF_CHANNELS];
+	unsigned long long t0, t1;
+	unsigned long saved_mie;
+	unsigned int n, i, num;
+	uint32_t mask;
+	int32_t req;
+
+	for(num = 0;num < DMA_NUMBER_OF_CHANNELS;num++)
+	{
+		req = dma_channel_request(DMA_CHANNEL_ANY, DMA_PRIO_NORMAL);
+		if(req == -1)
+		{
+			break;
+		}
+		ch[num] = req;
+	}
+
+	printf("\r\nCycles of dma_irq_handler(), %u free channels:\r\n", num);
+
+	for(n = 1;n <= num;n++)
+	{
+		// No console transfer in the way
+		uart_flush();
+		saved_mie = clear_csr(NDS_MSTATUS, MSTATUS_MIE) & MSTATUS_MIE;
+
+		mask = 0;
+		for(i = 0;i < n;i++)
+		{
+			dma_memcpy_async(&irq_copy[i], ch[i], buf + 2*BENCH_IRQ_SIZE*i + BENCH_IRQ_SIZE, buf + 2*BENCH_IRQ_SIZE*i,
+							 BENCH_IRQ_SIZE, NULL);
+			mask |= 1U << (16 + ch[i]);
+		}
+
+		while((DEV_DMA->INTSTATUS & mask) != mask);
+
+		t0 = rdmcycle();
+		dma_irq_handler();
+		t1 = rdmcycle();
+
+		set_csr(NDS_MSTATUS, saved_mie);
+
+		printf("  %u pending: %6u\r\n", n, (unsigned int)(t1 - t0));
+	}
+
+	for(i = 0;i < num;i++)
+	{
+		dma_channel_release(ch[i]);
+	}
+}
+
+// Print the telemetry of a channel, kept with CFG_DMA_STATS
+static void print_channel_stats(uint8_t ch)
+{
+	DMA_CHANNEL_STATS stats;
+	unsigned int i;
+
+	if(dma_channel_get_stats(ch, &stats) != 0)
+	{
+		return;
+	}
+
+	printf("\r\nDMA channel %u: %u transfers, %u KB, %u errors, %u aborts\r\n", (unsigned int)ch,
+			(unsigned int)stats.transfers, (unsigned int)(stats.bytes >> 10),
+			(unsigned int)stats.errors, (unsigned int)stats.aborts);
+
+	if(stats.transfers == 0)
+	{
+		return;
+	}
+
+	printf("  Latency: min %u, max %u, mean %u cycles\r\n", (unsigned int)stats.lat_min, (unsigned int)stats.lat_max,
+			(unsigned int)(stats.cycles / stats.transfers));
+
+	for(i = 0;i < DMA_STATS_LAT_BUCKETS;i++)
+	{
+		if(stats.lat_hist[i])
+		{
+			printf("  >= %10u: %u\r\n", 1U << i, (unsigned int)stats.lat_hist[i]);
+		}
+	}
+}
+
+// Completion callback, runs in the DMA interrupt
+static void copy_event(DMA_COPY *c)
+{
+	copy_done = 1;
+}
+
+// Application entry function
+int demo_dma(void)
+{
+	unsigned char *ddr, *dlm;
+	unsigned int size, loops;
+	DMA_ALLOC_STATS stats;
+	DMA_2D blk;
+	struct _cctl_stats cctl;
+	int32_t ch;
+
+	// Initializes UART
+	uart_init(38400);	// Baud rate is 38400
+
+	printf("\r\nIt's a DMA copy benchmark demo.\r\n\r\n");
+
+	dma_initialize();
+
+	ch = dma_channel_request(DMA_CHANNEL_ANY, DMA_PRIO_NORMAL);
+	if(ch == -1)
+	{
+		printf("No free DMA channel.\r\n");
+		dma_uninitialize();
+		return 0;
+	}
+	copy_ch = ch;
+	printf("DMA channel %d\r\n\r\n", (int)ch);
+
+	ddr = mem_malloc_region(2*BENCH_DDR_SIZE_MAX, MEM_REGION_DDR);
+	dlm = mem_malloc_region(BENCH_DLM_SIZE_MAX, MEM_REGION_DLM);
+
+	if(!ddr)
+	{
+		printf("No DDR buffer.\r\n");
+		dma_channel_release(copy_ch);
+		dma_uninitialize();
+		return 0;
+	}
+
+	printf("Cycles, DDR to DDR:\r\n");
+	for(size = 256;size <= BENCH_DDR_SIZE_MAX;size <<= 2)
+	{
+		bench_copy("DDR", ddr + BENCH_DDR_SIZE_MAX, ddr, size);
+		bench_set("DDR", ddr, size);
+	}
+
+	// Unaligned source, the DMA moves bytes
+	bench_copy("DDR+1", ddr + BENCH_DDR_SIZE_MAX, ddr + 1, 4096);
+
+	printf("\r\nAHB throughput, bytes against the widths of the alignment:\r\n");
+	bench_width("aligned", ddr + BENCH_DDR_SIZE_MAX, ddr, BENCH_WIDTH_SIZE);
+	bench_width("+1/+1", ddr + BENCH_DDR_SIZE_MAX + 1, ddr + 1, BENCH_WIDTH_SIZE);
+	bench_width("+1/+0", ddr + BENCH_DDR_SIZE_MAX, ddr + 1, BENCH_WIDTH_SIZE);
+	bench_width("+3/+2", ddr + BENCH_DDR_SIZE_MAX + 2, ddr + 3, BENCH_WIDTH_SIZE - 5);
+
+	if(dlm)
+	{
+		printf("\r\nCycles, DDR to DLM and back:\r\n");
+		for(size = 256;size <= BENCH_DLM_SIZE_MAX;size <<= 2)
+		{
+			bench_copy("DDR>DLM", dlm, ddr, size);
+			bench_copy("DLM>DDR", ddr, dlm, size);
+			bench_set("DLM", dlm, size);
+		}
+
+		printf("\r\nCycles, DDR frame of %u byte rows to DLM:\r\n", BENCH_FRAME_WIDTH);
+		for(size = 0;size < BENCH_FRAME_WIDTH * BENCH_TILE_HEIGHT;size++)
+		{
+			ddr[size] = size * 3 + 1;
+		}
+
+		// Tile at column 128, row 0, packed in the DLM
+		blk.src_addr   = (uint32_t)(long)(ddr + 128);
+		blk.dst_addr   = (uint32_t)(long)dlm;
+		blk.width      = BENCH_TILE_WIDTH;
+		blk.height     = BENCH_TILE_HEIGHT;
+		blk.src_stride = BENCH_FRAME_WIDTH;
+		blk.dst_stride = BENCH_TILE_WIDTH;
+		bench_2d("tile", &blk);
+
+		// Every 8th word of the frame
+		blk.src_addr   = (uint32_t)(long)ddr;
+		blk.width      = 4;
+		blk.height     = BENCH_2D_DESC;
+		blk.src_stride = 32;
+		blk.dst_stride = 4;
+		bench_2d("8th word", &blk);
+
+		mem_free(dlm);
+	}
+
+	dma_channel_release(copy_ch);
+
+	print_channel_stats(copy_ch);
+
+	bench_irq(ddr);
+
+	// The CPU is free while the DMA copies, the channel is given back before the callback
+	copy_done = 0;
+	loops = 0;
+	dma_memcpy_async(&copy, DMA_CHANNEL_ANY, ddr + BENCH_DDR_SIZE_MAX, ddr, BENCH_DDR_SIZE_MAX, copy_event);
+	while(!copy_done)
+	{
+		loops++;
+	}
+	printf("\r\nCPU loops during a %u byte DMA copy: %u\r\n", BENCH_DDR_SIZE_MAX, loops);
+
+	mem_free(ddr);
+
+	dma_alloc_get_stats(&stats);
+	printf("\r\nDMA channels: %u requests, %u fallbacks, %u failures, %u busy, %u in use, %u max\r\n",
+			(unsigned int)stats.requests, (unsigned int)stats.fallbacks, (unsigned int)stats.failures,
+			(unsigned int)stats.busy, (unsigned int)stats.in_use, (unsigned int)stats.high_water);
+
+	ae350_cctl_get_stats(&cctl);
+	printf("D-Cache: %u write backs, %u skipped, %u invalidations, %u skipped, %u whole\r\n",
+			(unsigned int)cctl.writeback, (unsigned int)cctl.writeback_skipped,
+			(unsigned int)cctl.invalidate, (unsigned int)cctl.invalidate_skipped,
+			(unsigned int)cctl.whole);
+
+	dma_uninitialize();
+
+	printf("\r\nDMA copy benchmark demo completed.\r\n");
+
+	return 0;
+}
+
+#endif	/* RUN_DEMO_DMA */
@@ -113,6 +113,16 @@ int main(void)
 	demo_mm();
 #endif
 
+	// Run memory management benchmark demo
+#if RUN_DEMO_MM_BENCH
+	demo_mm_bench();
+#endif
+
+	// Run DMA copy benchmark demo
+#if RUN_DEMO_DMA
+	demo_dma();
+#endif
+
 	// Run multiple peripherals interrupts demo
 #if RUN_DEMO_INTR
 	demo_intr();
@@ -16,6 +16,12 @@
  * After memory initialized, the demo program will allocate a memory to the character arrays.
  * Set an array values, copy this array to another array, compare these arrays. Finally,
  * free these memory.
+ *
+ * Then a hot buffer is placed in DLM and a bulk buffer in DDR by the region heaps, the hot
+ * buffer falling back to the next regions when DLM is not available.
+ *
+ * Last, frames are processed with temporary buffers from an arena, released at the end of
+ * each frame at once, and the arena peak usage is printed.
  ********************************************************************************************
 * */
 
@@ -28,11 +34,13 @@
 // *********** Includes *********** //
 #include "uart.h"
 #include "mm.h"
+#include "arena.h"
 #include <stdio.h>
 
 
 // ********** Definitions ********* //
 #define M_SIZE	100
+#define FRAMES	4
 
 
 // Application entry function
@@ -87,6 +95,58 @@ int demo_mm(void)
 	mem_free(b);
 	printf("free b PASS.\r\n");
 
+	// Heap statistics, mem_stats_send() sends the same as a binary record
+	mem_stats_t stats;
+
+	mem_stats(MEM_REGION_DEFAULT, &stats);
+	printf("\r\nheap: total %d, used %d, peak %d, largest free %d, %d fragments, %d failed\r\n",
+			stats.total, stats.used, stats.peak, stats.largest_free, stats.fragments, stats.fail);
+
+	// Region heaps
+	printf("\r\nregions: DLM %d, ILM %d, DDR %d bytes\r\n", mem_region_size(MEM_REGION_DLM),
+			mem_region_size(MEM_REGION_ILM), mem_region_size(MEM_REGION_DDR));
+
+	a = (unsigned char*)mem_malloc_region(M_SIZE, MEM_REGION_DLM | MEM_REGION_FALLBACK);
+	printf("allocate hot a at 0x%x\r\n", (unsigned int)a);
+
+	b = (unsigned char*)mem_malloc_region(64*1024, MEM_REGION_DDR);
+	printf("allocate bulk b at 0x%x\r\n", (unsigned int)b);
+
+	mem_free(a);
+	mem_free(b);
+	printf("free a and b PASS.\r\n");
+
+	// Arena
+	mem_arena_t arena;
+	mem_arena_mark_t frame, stage;
+
+	if(mem_arena_init(&arena, 4096, MEM_REGION_DEFAULT))
+	{
+		printf("\r\narena init FAIL.\r\n");
+		return 0;
+	}
+
+	for(int f = 0;f < FRAMES;f++)
+	{
+		frame = mem_arena_save(&arena);
+
+		a = (unsigned char*)mem_arena_alloc(&arena, M_SIZE * (f + 1));
+
+		// Nested stage, released before the end of the frame
+		stage = mem_arena_save(&arena);
+		b = (unsigned char*)mem_arena_alloc_aligned(&arena, M_SIZE, 32);
+		mem_set(b, f, M_SIZE);
+		mem_arena_restore(&arena, stage);
+
+		mem_set(a, f, M_SIZE * (f + 1));
+		printf("\r\nframe %d: a at 0x%x, used %d bytes", f, (unsigned int)a, mem_arena_used(&arena));
+
+		mem_arena_restore(&arena, frame);
+	}
+
+	printf("\r\narena peak %d bytes, %d failed\r\n", arena.peak, arena.fail);
+	mem_arena_deinit(&arena);
+
 	return 0;
 }
 
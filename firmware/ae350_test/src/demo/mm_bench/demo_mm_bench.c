@@ -0,0 +1,623 @@
+/*
+ * ******************************************************************************************
+ * File		: demo_mm_bench.c
+ * Author	: GowinSemicoductor
+ * Chip		: AE350_SOC
+ * Function	: Memory management benchmark demo
+ * ******************************************************************************************
+ */
+
+/*
+ ********************************************************************************************
+ * This demo measures the latency of the memory management by 'mcycle'.
+ *
+ * Scenario:
+ *
+ * The same pseudo random allocate/free sequence is run against the TLSF heap of mm.c and
+ * against the former memory table allocator, kept here as reference. The heap is first
+ * fragmented by freeing every other block, then the minimum, average and maximum cycles of
+ * each allocation and free are printed. Build with a bigger MEM_MAX_SIZE to see the table
+ * allocator latency grow with the heap size while the TLSF one stays bounded.
+ *
+ * The fixed-size object pool is then run through the same sequence and its high-water
+ * mark is printed.
+ *
+ * Finally mem_cpy, mem_set and mem_cmp are timed from 1 byte to 1 MB in DDR and in a buffer
+ * of the ILM and DLM region heaps, next to a byte by byte copy as reference. A local memory
+ * is skipped when it has no region heap, e.g. when disabled.
+ *
+ * An append workload then grows a few buffers step by step, once by allocate, copy and free
+ * and once by mem_realloc(), and prints the cycles and the number of data copies.
+ *
+ * With the cache enabled, the cache maintenance after a DMA receive is timed on a buffer
+ * that does not start on a cache line, which goes through the partial line handling with
+ * interrupts disabled, and on a buffer from mem_malloc_dma(), invalidated by whole lines.
+ * A buffer from mem_malloc_dma() is then grown, shrunk and freed by mem_realloc(), and
+ * must stay line aligned inside the DMA heap.
+ ********************************************************************************************
+ */
+
+// Includes ---------------------------------------------------------------------------------
+#include "demo.h"
+
+// If running memory management benchmark demo
+#if RUN_DEMO_MM_BENCH
+
+// ************ Includes ************ //
+#include "platform.h"
+#include "uart.h"
+#include "mm.h"
+#include "pool.h"
+
+// If enable L1 cache
+#ifdef CFG_CACHE_ENABLE
+#include "cache.h"
+#endif
+#include <stdio.h>
+
+
+// ********** Definitions ********** //
+
+#define BENCH_SLOTS				64			// Live allocations
+#define BENCH_ROUNDS			512			// Measured allocate/free pairs
+#define BENCH_SIZE_MAX			96			// Largest request in bytes
+
+// Append workload
+#define BENCH_APPEND_BUFS		4
+#define BENCH_APPEND_STEP		24
+#define BENCH_APPEND_MAX		768
+
+// Copy throughput
+#define BENCH_DDR_SIZE_MAX		0x100000
+#define BENCH_REPEAT_BYTES		4096		// Small sizes are repeated up to this amount
+
+// Former memory table allocator, reference only
+#define LEGACY_BLOCK_SIZE		8
+#define LEGACY_TABLE_SIZE		(MEM_MAX_SIZE/LEGACY_BLOCK_SIZE)
+
+typedef struct
+{
+	unsigned int min;
+	unsigned int max;
+	unsigned long long sum;
+	unsigned int cnt;
+} bench_stat_t;
+
+static unsigned char legacy_membase[MEM_MAX_SIZE];
+static unsigned char legacy_memmap[LEGACY_TABLE_SIZE];
+
+MEM_POOL_DEFINE(bench_pool, BENCH_SIZE_MAX, BENCH_SLOTS);
+
+static void* slot[BENCH_SLOTS];
+static unsigned int seed;
+
+/*
+ * The 'mcycle' counter is 64-bit counter. But RV32 access
+ * it as two 32-bit registers, so we check for rollover
+ * with this routine as suggested by the RISC-V Privileged
+ * Architecture Specification.
+ */
+__attribute__((always_inline))
+static inline unsigned long long rdmcycle(void)
+{
+#if __riscv_xlen == 32
+	do
+	{
+		unsigned long hi = read_csr(NDS_MCYCLEH);
+		unsigned long lo = read_csr(NDS_MCYCLE);
+
+		if (hi == read_csr(NDS_MCYCLEH))
+		{
+			return ((unsigned long long)hi << 32) | lo;
+		}
+	} while(1);
+#else
+	return read_csr(NDS_MCYCLE);
+#endif
+}
+
+// Pseudo random number, same sequence for both allocators
+static unsigned int bench_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+
+	return (seed >> 16) & 0x7FFF;
+}
+
+static void legacy_init(void)
+{
+	mem_set(legacy_memmap, 0, LEGACY_TABLE_SIZE);
+}
+
+static void* legacy_malloc(unsigned int size)
+{
+	signed long offset;
+	unsigned int nmemb;
+	unsigned int cmemb = 0;
+	unsigned int i;
+
+	nmemb = (size + LEGACY_BLOCK_SIZE - 1)/LEGACY_BLOCK_SIZE;
+
+	for(offset = LEGACY_TABLE_SIZE - 1;offset >= 0;offset--)
+	{
+		if(!legacy_memmap[offset])
+		{
+			cmemb++;
+		}
+		else
+		{
+			cmemb = 0;
+		}
+
+		if(cmemb == nmemb)
+		{
+			for(i = 0;i < nmemb;i++)
+			{
+				legacy_memmap[offset+i] = nmemb;
+			}
+
+			return &legacy_membase[offset*LEGACY_BLOCK_SIZE];
+		}
+	}
+
+	return 0;
+}
+
+static void legacy_free(void *ptr)
+{
+	unsigned int index = ((unsigned char *)ptr - legacy_membase)/LEGACY_BLOCK_SIZE;
+	unsigned int nmemb = legacy_memmap[index];
+	unsigned int i;
+
+	for(i = 0;i < nmemb;i++)
+	{
+		legacy_memmap[index+i] = 0;
+	}
+}
+
+static void stat_reset(bench_stat_t *stat)
+{
+	stat->min = 0xFFFFFFFF;
+	stat->max = 0;
+	stat->sum = 0;
+	stat->cnt = 0;
+}
+
+static void stat_add(bench_stat_t *stat, unsigned int cycles)
+{
+	if(cycles < stat->min)
+	{
+		stat->min = cycles;
+	}
+	if(cycles > stat->max)
+	{
+		stat->max = cycles;
+	}
+	stat->sum += cycles;
+	stat->cnt++;
+}
+
+static void stat_print(const char *name, bench_stat_t *stat)
+{
+	if(!stat->cnt)
+	{
+		printf("  %s: no sample\r\n", name);
+		return;
+	}
+
+	printf("  %s: min %u, avg %u, max %u cycles\r\n", name, stat->min,
+			(unsigned int)(stat->sum / stat->cnt), stat->max);
+}
+
+static void* pool_alloc(unsigned int size)
+{
+	return mem_pool_get(&bench_pool);
+}
+
+static void pool_release(void *ptr)
+{
+	mem_pool_put(&bench_pool, ptr);
+}
+
+// Run the allocate/free sequence against one allocator
+static void bench_run(const char *name, void* (*alloc)(unsigned int), void (*release)(void *))
+{
+	bench_stat_t st_alloc, st_free;
+	unsigned long long begin;
+	unsigned int cycles;
+	unsigned int fail = 0;
+	int i, n;
+
+	seed = 1;
+	stat_reset(&st_alloc);
+	stat_reset(&st_free);
+
+	// Fill, then fragment the heap by freeing every other block
+	for(i = 0;i < BENCH_SLOTS;i++)
+	{
+		slot[i] = alloc(1 + bench_rand() % BENCH_SIZE_MAX);
+	}
+	for(i = 0;i < BENCH_SLOTS;i += 2)
+	{
+		if(slot[i])
+		{
+			release(slot[i]);
+			slot[i] = 0;
+		}
+	}
+
+	// Measure random replacement
+	for(n = 0;n < BENCH_ROUNDS;n++)
+	{
+		i = bench_rand() % BENCH_SLOTS;
+
+		if(slot[i])
+		{
+			begin = rdmcycle();
+			release(slot[i]);
+			cycles = (unsigned int)(rdmcycle() - begin);
+			stat_add(&st_free, cycles);
+			slot[i] = 0;
+		}
+
+		begin = rdmcycle();
+		slot[i] = alloc(1 + bench_rand() % BENCH_SIZE_MAX);
+		cycles = (unsigned int)(rdmcycle() - begin);
+
+		if(slot[i])
+		{
+			stat_add(&st_alloc, cycles);
+		}
+		else
+		{
+			fail++;
+		}
+	}
+
+	for(i = 0;i < BENCH_SLOTS;i++)
+	{
+		if(slot[i])
+		{
+			release(slot[i]);
+			slot[i] = 0;
+		}
+	}
+
+	printf("%s, %d allocations failed\r\n", name, fail);
+	stat_print("allocate", &st_alloc);
+	stat_print("free    ", &st_free);
+}
+
+// Byte by byte copy, reference
+static void byte_cpy(void *des, void *src, unsigned int n)
+{
+	volatile unsigned char *xdes = des;
+	unsigned char *xsrc = src;
+
+	while(n--)
+	{
+		*xdes++ = *xsrc++;
+	}
+}
+
+// Average cycles of one call over the repeat count
+static unsigned int bench_time(void (*fn)(void *, void *, unsigned int), void *des, void *src, unsigned int n, unsigned int repeat)
+{
+	unsigned long long begin = rdmcycle();
+	unsigned int i;
+
+	for(i = 0;i < repeat;i++)
+	{
+		fn(des, src, n);
+	}
+
+	return (unsigned int)((rdmcycle() - begin) / repeat);
+}
+
+static void set_fn(void *des, void *src, unsigned int n)
+{
+	mem_set(des, 0x5A, n);
+}
+
+static void cmp_fn(void *des, void *src, unsigned int n)
+{
+	mem_cmp(des, src, n);
+}
+
+// Throughput of the copy kernels in one memory, source and destination both in it
+static void bench_copy(const char *name, unsigned char *mem, unsigned int size_max)
+{
+	unsigned char *src = mem;
+	unsigned char *des = mem + size_max;
+	unsigned int size, repeat;
+
+	printf("\r\n%s at 0x%x\r\n", name, (unsigned int)(unsigned long)mem);
+	printf("     size   mem_cpy   mem_set   mem_cmp  byte_cpy  (cycles)\r\n");
+
+	mem_set(src, 0xA5, size_max);
+	mem_set(des, 0xA5, size_max);
+
+	for(size = 1;size <= size_max;size <<= 1)
+	{
+		repeat = (size < BENCH_REPEAT_BYTES) ? BENCH_REPEAT_BYTES/size : 1;
+
+		printf("%9u %9u %9u %9u %9u\r\n", size,
+				bench_time(mem_cpy, des, src, size, repeat),
+				bench_time(set_fn, des, src, size, repeat),
+				bench_time(cmp_fn, des, src, size, repeat),
+				bench_time(byte_cpy, des, src, size, repeat));
+
+		// Put the destination back equal to the source for mem_cmp
+		mem_set(des, 0xA5, size);
+	}
+}
+
+// Throughput of the copy kernels in a buffer of a region heap, skipped if the region has none
+static void bench_copy_region(const char *name, unsigned int region)
+{
+	mem_stats_t stats;
+	unsigned char *buf;
+	unsigned int half = 1;
+
+	if(mem_stats(region, &stats))
+	{
+		return;
+	}
+
+	// Halves of a power of two buffer taking at most half of the largest free block
+	while(half*4 <= stats.largest_free)
+	{
+		half <<= 1;
+	}
+
+	buf = mem_malloc_region(2*half, region);
+	if(buf)
+	{
+		bench_copy(name, buf, half);
+		mem_free(buf);
+	}
+}
+
+// Grow buffers by appending, realloc_fn is 0 for allocate, copy and free
+static void bench_append(const char *name, void* (*realloc_fn)(void *, unsigned int))
+{
+	unsigned char *buf[BENCH_APPEND_BUFS] = {0};
+	unsigned char *grown;
+	unsigned int len = 0;
+	unsigned int copies = 0;
+	unsigned long long begin;
+	mem_stats_t stats;
+	int i;
+
+	mem_stats(MEM_REGION_DEFAULT, &stats);
+	copies = stats.moves;
+
+	begin = rdmcycle();
+
+	while(len < BENCH_APPEND_MAX)
+	{
+		for(i = 0;i < BENCH_APPEND_BUFS;i++)
+		{
+			if(realloc_fn)
+			{
+				grown = realloc_fn(buf[i], len + BENCH_APPEND_STEP);
+			}
+			else
+			{
+				grown = mem_malloc(len + BENCH_APPEND_STEP);
+				if(grown && buf[i])
+				{
+					mem_cpy(grown, buf[i], len);
+					copies++;
+				}
+				if(grown)
+				{
+					mem_free(buf[i]);
+				}
+			}
+
+			if(!grown)
+			{
+				break;
+			}
+
+			mem_set(grown + len, i, BENCH_APPEND_STEP);
+			buf[i] = grown;
+		}
+
+		if(i < BENCH_APPEND_BUFS)
+		{
+			break;
+		}
+
+		len += BENCH_APPEND_STEP;
+
+		// Let one buffer grow alone for a while, its neighbour is then free
+		if(len == BENCH_APPEND_MAX/2)
+		{
+			mem_free(buf[BENCH_APPEND_BUFS - 1]);
+			buf[BENCH_APPEND_BUFS - 1] = 0;
+		}
+	}
+
+	begin = rdmcycle() - begin;
+
+	if(realloc_fn)
+	{
+		mem_stats(MEM_REGION_DEFAULT, &stats);
+		copies = stats.moves - copies;
+	}
+
+	for(i = 0;i < BENCH_APPEND_BUFS;i++)
+	{
+		mem_free(buf[i]);
+	}
+
+	printf("%s: %u bytes per buffer, %u copies, %u cycles\r\n", name, len, copies, (unsigned int)begin);
+}
+
+#ifdef CFG_CACHE_ENABLE
+// Cycles of the cache maintenance after a DMA receive, critical section included
+static void bench_dma_invalidate(void)
+{
+	static const unsigned int sizes[] = {64, 256, 1024, 4096};
+	unsigned long long begin;
+	unsigned int partial, whole;
+	unsigned char *raw, *part, *buf;
+	unsigned int i;
+
+	printf("\r\nDMA receive invalidation, cache line %u bytes\r\n", (unsigned int)cache_line_size());
+	printf("     size  unaligned  mem_malloc_dma  (cycles)\r\n");
+
+	for(i = 0;i < sizeof(sizes)/sizeof(sizes[0]);i++)
+	{
+		raw = mem_malloc_region(sizes[i] + 2*cache_line_size(), MEM_REGION_DDR | MEM_REGION_FALLBACK);
+		buf = mem_malloc_dma(sizes[i]);
+		if(!raw || !buf)
+		{
+			printf("%9u  no memory\r\n", sizes[i]);
+			mem_free(raw);
+			mem_free(buf);
+			continue;
+		}
+
+		// Start inside a line and dirty the lines around
+		part = (unsigned char *)((((unsigned long)raw + cache_line_size()) & ~(cache_line_size() - 1)) + 4);
+		mem_set(part - 4, 0x11, sizes[i] + 8);
+		mem_set(buf, 0x22, sizes[i]);
+
+		begin = rdmcycle();
+		ae350_dma_invalidate_range2((unsigned long)part, sizes[i]);
+		partial = (unsigned int)(rdmcycle() - begin);
+
+		begin = rdmcycle();
+		if(ae350_dma_is_line_safe((unsigned long)buf, sizes[i]))
+		{
+			ae350_dma_invalidate_lines((unsigned long)buf, sizes[i]);
+		}
+		whole = (unsigned int)(rdmcycle() - begin);
+
+		printf("%9u %10u %15u\r\n", sizes[i], partial, whole);
+
+		mem_free(buf);
+		mem_free(raw);
+	}
+}
+
+// Check a DMA buffer stays whole lines of the DMA heap when resized
+static int dma_realloc_check(unsigned char *buf, unsigned int size, unsigned int fill)
+{
+	unsigned int i, line = cache_line_size();
+
+	// The buffer is padded to whole lines
+	size = (size + line - 1) & ~(line - 1);
+	if(!buf || !ae350_dma_is_line_safe((unsigned long)buf, size))
+	{
+		return 1;
+	}
+
+	for(i = 0;i < fill;i++)
+	{
+		if(buf[i] != (unsigned char)i)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Resize a buffer from mem_malloc_dma(), grown past a neighbour, shrunk and freed by mem_realloc()
+static void bench_dma_realloc(void)
+{
+	unsigned char *buf, *next;
+	mem_stats_t before, after;
+	int err = 0;
+	unsigned int i;
+
+	buf = mem_malloc_dma(256);
+	next = mem_malloc_dma(256);		// Keeps buf from growing in place
+	if(!buf || !next)
+	{
+		printf("\r\nDMA buffer mem_realloc: no memory\r\n");
+		mem_free(buf);
+		mem_free(next);
+		return;
+	}
+
+	for(i = 0;i < 256;i++)
+	{
+		buf[i] = i;
+	}
+
+	// The DDR heap holding the DMA heap must not see its blocks
+	mem_stats(MEM_REGION_DDR, &before);
+
+	buf = mem_realloc(buf, 1024);
+	err |= dma_realloc_check(buf, 1024, 256);
+
+	if(buf)
+	{
+		buf = mem_realloc(buf, 100);
+		err |= dma_realloc_check(buf, 100, 100);
+	}
+
+	mem_realloc(buf, 0);
+	mem_free(next);
+
+	mem_stats(MEM_REGION_DDR, &after);
+	err |= (after.used != before.used);
+
+	printf("\r\nDMA buffer mem_realloc: %s\r\n", err ? "left the DMA heap, FAILED" : "stays in the DMA heap");
+}
+#endif
+
+
+// Application entry function
+int demo_mm_bench(void)
+{
+	unsigned char *ddr;
+
+	// Initializes UART
+	uart_init(38400);	// Baud rate is 38400
+
+	printf("\r\nIt's a Memory Management Benchmark demo.\r\n\r\n");
+
+	// The static heap initializes itself on first use, its live blocks are kept
+	legacy_init();
+
+	printf("Heap size %d bytes, %d live blocks of 1 to %d bytes\r\n\r\n", MEM_MAX_SIZE, BENCH_SLOTS, BENCH_SIZE_MAX);
+
+	bench_run("TLSF heap", mem_malloc, mem_free);
+	bench_run("Memory table heap", legacy_malloc, legacy_free);
+
+	printf("\r\n");
+	bench_append("Allocate, copy, free", 0);
+	bench_append("mem_realloc", mem_realloc);
+
+	mem_pool_reset(&bench_pool);
+	bench_run("Object pool", pool_alloc, pool_release);
+	printf("  high-water %u of %u objects, %u empty gets\r\n", bench_pool.high_water,
+			bench_pool.obj_count, bench_pool.fail);
+
+	// Source and destination from the DDR heap
+	ddr = mem_malloc_region(2*BENCH_DDR_SIZE_MAX, MEM_REGION_DDR);
+	if(ddr)
+	{
+		bench_copy("DDR", ddr, BENCH_DDR_SIZE_MAX);
+		mem_free(ddr);
+	}
+
+	// Local memories, from their region heaps so their allocator control stays intact
+	bench_copy_region("ILM", MEM_REGION_ILM);
+	bench_copy_region("DLM", MEM_REGION_DLM);
+
+#ifdef CFG_CACHE_ENABLE
+	bench_dma_invalidate();
+	bench_dma_realloc();
+#endif
+
+	return 0;
+}
+
+#endif	/* RUN_DEMO_MM_BENCH */
@@ -16,6 +16,9 @@
  *
  * Use STD printf() function to output message (string, character, integer, hex...) to UART.
  * Use STD sprintf() function to output message to a buffer.
+ * Print 64-bit 'mcycle' with %llu and compare the cycles of sprintf() on the same formats
+ * with a copy of the former printf.c, which converted one digit per step.
+ * Use LOG() to output message, or binary records decoded by tools/logdec.py with LOG_BINARY.
  * Control output of UART1 or UART2 port in uart.h
  ********************************************************************************************
  */
@@ -28,10 +31,328 @@
 
 // ************ Includes *********** //
 #include "uart.h"
+#include "log.h"
+#include "platform.h"
+#include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 
 // ********** Definitions ********** //
+
+#define BENCH_LOOPS		1000
+
+/*
+ * The 'mcycle' counter is 64-bit counter. But RV32 access
+ * it as two 32-bit registers, so we check for rollover
+ * with this routine as suggested by the RISC-V Privileged
+ * Architecture Specification.
+ */
+__attribute__((always_inline))
+static inline unsigned long long rdmcycle(void)
+{
+#if __riscv_xlen == 32
+	do
+	{
+		unsigned long hi = read_csr(NDS_MCYCLEH);
+		unsigned long lo = read_csr(NDS_MCYCLE);
+
+		if (hi == read_csr(NDS_MCYCLEH))
+		{
+			return ((unsigned long long)hi << 32) | lo;
+		}
+	} while(1);
+#else
+	return read_csr(NDS_MCYCLE);
+#endif
+}
+
+/*
+ * Former printf.c, kept here as reference for the benchmark: one '%' and one '/' per
+ * digit, and no 64-bit conversions. Only the sprintf() path is kept.
+ */
+#define LEGACY_PAD_RIGHT 1
+#define LEGACY_PAD_ZERO 2
+
+/* The following should be enough for 32 bit integer */
+#define LEGACY_PRINT_BUF_LEN 12
+
+static void legacy_printchar(char **str, int c)
+{
+	**str = c;
+	++(*str);
+}
+
+static int legacy_prints(char **out, const char *string, int width, int pad)
+{
+	register int pc = 0, padchar = ' ';
+
+	if (width > 0)
+	{
+		register int len = 0;
+		register const char *ptr;
+
+		for (ptr = string; *ptr; ++ptr)
+		{
+			++len;
+		}
+
+		if (len >= width)
+		{
+			width = 0;
+		}
+		else
+		{
+			width -= len;
+		}
+
+		if (pad & LEGACY_PAD_ZERO)
+		{
+			padchar = '0';
+		}
+	}
+
+	if (!(pad & LEGACY_PAD_RIGHT))
+	{
+		for ( ; width > 0; --width)
+		{
+			legacy_printchar (out, padchar);
+			++pc;
+		}
+	}
+
+	for ( ; *string ; ++string)
+	{
+		legacy_printchar (out, *string);
+		++pc;
+	}
+
+	for ( ; width > 0; --width)
+	{
+		legacy_printchar (out, padchar);
+		++pc;
+	}
+
+	return pc;
+}
+
+static int legacy_printi(char **out, int i, int b, int sg, int width, int pad, int letbase)
+{
+	char print_buf[LEGACY_PRINT_BUF_LEN];
+	register char *s;
+	register int t, neg = 0, pc = 0;
+	register unsigned int u = i;
+
+	if (i == 0)
+	{
+		print_buf[0] = '0';
+		print_buf[1] = '\0';
+
+		return legacy_prints (out, print_buf, width, pad);
+	}
+
+	if (sg && b == 10 && i < 0)
+	{
+		neg = 1;
+		u = -i;
+	}
+
+	s = print_buf + LEGACY_PRINT_BUF_LEN-1;
+	*s = '\0';
+
+	while (u)
+	{
+		t = u % b;
+		if( t >= 10 )
+		{
+			t += letbase - '0' - 10;
+		}
+
+		*--s = t + '0';
+		u /= b;
+	}
+
+	if (neg)
+	{
+		if( width && (pad & LEGACY_PAD_ZERO) )
+		{
+			legacy_printchar (out, '-');
+			++pc;
+			--width;
+		}
+		else
+		{
+			*--s = '-';
+		}
+	}
+
+	return pc + legacy_prints (out, s, width, pad);
+}
+
+static int legacy_print(char **out, const char *format, va_list args)
+{
+	register int width, pad;
+	register int pc = 0;
+	char scr[2];
+
+	for (; *format != 0; ++format)
+	{
+		if (*format == '%')
+		{
+			++format;
+			width = pad = 0;
+
+			if (*format == '\0')
+			{
+				break;
+			}
+
+			if (*format == '%')
+			{
+				goto out;
+			}
+
+			if (*format == '-')
+			{
+				++format;
+				pad = LEGACY_PAD_RIGHT;
+			}
+
+			while (*format == '0')
+			{
+				++format;
+				pad |= LEGACY_PAD_ZERO;
+			}
+
+			for ( ; *format >= '0' && *format <= '9'; ++format)
+			{
+				width *= 10;
+				width += *format - '0';
+			}
+
+			if( *format == 's' )
+			{
+				register char *s = (char *)((long)va_arg( args, int ));
+				pc += legacy_prints (out, s?s:"(null)", width, pad);
+				continue;
+			}
+
+			if( *format == 'd' )
+			{
+				pc += legacy_printi (out, va_arg( args, int ), 10, 1, width, pad, 'a');
+				continue;
+			}
+
+			if( *format == 'x' )
+			{
+				pc += legacy_printi (out, va_arg( args, int ), 16, 0, width, pad, 'a');
+				continue;
+			}
+
+			if( *format == 'X' )
+			{
+				pc += legacy_printi (out, va_arg( args, int ), 16, 0, width, pad, 'A');
+				continue;
+			}
+
+			if( *format == 'u' )
+			{
+				pc += legacy_printi (out, va_arg( args, int ), 10, 0, width, pad, 'a');
+				continue;
+			}
+
+			if( *format == 'c' )
+			{
+				/* Type char are converted to integer then pushed on the stack */
+				scr[0] = (char)va_arg( args, int );
+				scr[1] = '\0';
+				pc += legacy_prints (out, scr, width, pad);
+				continue;
+			}
+		}
+		else
+		{
+		out:
+			legacy_printchar (out, *format);
+			++pc;
+		}
+	}
+
+	**out = '\0';
+
+	va_end( args );
+
+	return pc;
+}
+
+static int legacy_sprintf(char *out, const char *format, ...)
+{
+	va_list args;
+
+	va_start( args, format );
+
+	return legacy_print( &out, format, args );
+}
+
+// Cycles per call of a sprintf() on a format with one integer
+static unsigned int bench_sprintf(int (*fn)(char *, const char *, ...), char *buf, const char *format, unsigned int value)
+{
+	unsigned long long begin;
+	int i;
+
+	begin = rdmcycle();
+	for (i = 0; i < BENCH_LOOPS; i++)
+	{
+		fn(buf, format, value);
+	}
+
+	return (unsigned int)(rdmcycle() - begin) / BENCH_LOOPS;
+}
+
+// Cycles of the same formats by the current and the former printf.c
+static void bench_printf(void)
+{
+	static const struct
+	{
+		const char *format;
+		unsigned int value;
+	} bench[] =
+	{
+		{"%u", 7},
+		{"%u", 4321},
+		{"%u", 1234567},
+		{"%u", 4000000000U},
+		{"%d", -1234567},
+		{"%08x", 0xBEEF},
+		{"%X", 0xDEADBEEFU},
+		{"x=%-8d|", 42},
+	};
+	char buf[32], ref[32];
+	unsigned long long begin;
+	unsigned int cycles, legacy;
+	unsigned int j;
+
+	printf("\r\nCycles per sprintf(), %d loops:\r\n", BENCH_LOOPS);
+	printf("  format        output       printf.c   former\r\n");
+
+	for (j = 0; j < sizeof(bench)/sizeof(bench[0]); j++)
+	{
+		cycles = bench_sprintf(sprintf, buf, bench[j].format, bench[j].value);
+		legacy = bench_sprintf(legacy_sprintf, ref, bench[j].format, bench[j].value);
+
+		printf("  %-8s %-14s %9u %8u%s\r\n", bench[j].format, buf, cycles, legacy,
+			   strcmp(buf, ref) ? "  differs" : "");
+	}
+
+	begin = rdmcycle();
+	for (j = 0; j < BENCH_LOOPS; j++)
+	{
+		sprintf(buf, "%llu", begin);
+	}
+	cycles = (unsigned int)(rdmcycle() - begin);
+	printf("%%llu %s: %u cycles, no former conversion\r\n", buf, cycles / BENCH_LOOPS);
+}
+
 int demo_printf(void)
 {
 	char *ptr = "Hello world!";
@@ -39,6 +360,7 @@ int demo_printf(void)
 	unsigned int bs = sizeof(int)*8;
 	int mi;
 	char buf[80];
+	unsigned long long now;
 
 	/* Initializes UART */
 	uart_init(38400);		// Baud rate is 38400
@@ -82,6 +404,14 @@ int demo_printf(void)
 	sprintf(buf, "-3: %4d right justif.\r\n", -3);
 	printf("%s", buf);
 
+	now = rdmcycle();
+	printf("mcycle %llu = 0x%llx\r\n", now, now);
+	printf("long %ld %lu, pointer %p\r\n", -1L, 1UL, buf);
+
+	bench_printf();
+
+	LOG("LOG %d %s(s), hex %x\r\n", 3, "message", 0xff);
+
 	return 0;
 }
 
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+#
+# ******************************************************************************************
+# File		: logdec.py
+# Author	: GowinSemicoductor
+# Chip		: AE350_SOC
+# Function	: Host decoder of the binary log records of bsp/lib/log.c
+# ******************************************************************************************
+#
+# Usage:
+#
+#   logdec.py ae350_test.adx /dev/ttyUSB0 [--baud 38400] [--hz 50000000]
+#   logdec.py ae350_test.adx capture.bin
+#
+# The format strings are read from the .logfmt section of the ELF file. Bytes that
+# are not part of a record, e.g. printf() output, are passed through unchanged.
+# Time stamps are in cycles, or in seconds with --hz.
+
+import argparse
+import os
+import re
+import stat
+import struct
+import sys
+
+SYNC0 = 0xA5
+SYNC1 = 0x4C
+
+SHF_ALLOC = 0x2
+
+CONV = re.compile(rb'%([-0 +#]*)(\d*)(?:\.(\d+))?(hh|h|ll|l)?([diuxXcsp%])')
+
+
+class Elf(object):
+	"""Sections of a 32-bit little endian ELF file"""
+
+	def __init__(self, path):
+		with open(path, 'rb') as f:
+			self.data = f.read()
+
+		if self.data[:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+			raise ValueError('%s: not a 32-bit little endian ELF file' % path)
+
+		shoff, = struct.unpack_from('<I', self.data, 0x20)
+		shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x2E)
+
+		headers = [struct.unpack_from('<IIIIIIIIII', self.data, shoff + i*shentsize) for i in range(shnum)]
+		names = headers[shstrndx]
+
+		self.sections = {}
+		self.alloc = []
+		for name, stype, flags, addr, offset, size, _, _, _, _ in headers:
+			end = self.data.index(b'\0', names[4] + name)
+			sname = self.data[names[4] + name:end].decode()
+			self.sections[sname] = (addr, offset, size)
+			# NOBITS sections have no file content
+			if (flags & SHF_ALLOC) and stype != 8 and size:
+				self.alloc.append((addr, offset, size))
+
+	def string(self, section, addr):
+		"""NUL terminated string at addr in a section, None if outside"""
+		base, offset, size = section
+		if not base <= addr < base + size:
+			return None
+		start = offset + addr - base
+		end = self.data.find(b'\0', start, offset + size)
+		return self.data[start:end if end >= 0 else offset + size]
+
+	def format(self, addr):
+		if '.logfmt' not in self.sections:
+			raise ValueError('no .logfmt section, build with LOG_BINARY 1')
+		return self.string(self.sections['.logfmt'], addr)
+
+	def loaded_string(self, addr):
+		for section in self.alloc:
+			s = self.string(section, addr)
+			if s is not None:
+				return s
+		return None
+
+
+def render(elf, fmt, args):
+	"""printf() on the host, arguments are 32-bit"""
+	args = list(args)
+
+	def conv(m):
+		flags, width, prec, _, c = m.groups()
+		if c == b'%':
+			return b'%'
+		if not args:
+			return b'<?>'
+		v = args.pop(0)
+		spec = '%' + flags.decode() + width.decode() + ('.' + prec.decode() if prec else '')
+		if c in b'di':
+			return ((spec + 'd') % (v - (1 << 32) if v & 0x80000000 else v)).encode()
+		if c == b'u':
+			return ((spec + 'd') % v).encode()
+		if c in b'xX':
+			return ((spec + c.decode()) % v).encode()
+		if c == b'p':
+			return ('0x%08x' % v).encode()
+		if c == b'c':
+			return ((spec + 'c') % chr(v & 0xFF)).encode()
+		s = elf.loaded_string(v)
+		if s is None:
+			s = b'<0x%08x>' % v
+		return ((spec + 's') % s.decode(errors='replace')).encode()
+
+	return CONV.sub(conv, fmt)
+
+
+def values(payload):
+	"""Unsigned LEB128 values"""
+	v = shift = 0
+	for b in payload:
+		v |= (b & 0x7F) << shift
+		shift += 7
+		if not b & 0x80:
+			yield v
+			v = shift = 0
+	if shift:
+		raise ValueError('truncated value')
+
+
+def record(elf, payload, cycles, hz):
+	"""Text of one record and the new time stamp"""
+	try:
+		v = list(values(payload))
+		fid, delta, nargs = v[:3]
+		args = v[3:3 + nargs]
+	except ValueError:
+		return b'<bad record>\n', cycles
+
+	cycles += delta
+	fmt = elf.format(fid)
+	if fmt is None:
+		return b'<unknown format 0x%x>\n' % fid, cycles
+
+	stamp = ('[%12.6f] ' % (cycles / hz)) if hz else ('[%12u] ' % cycles)
+	return stamp.encode() + render(elf, fmt, args), cycles
+
+
+def decode(elf, stream, out, hz):
+	buf = bytearray()
+	cycles = 0
+
+	while True:
+		byte = stream.read(1)
+		if not byte:
+			out.write(bytes(buf))
+			out.flush()
+			return
+		buf += byte
+
+		while buf:
+			# Pass text through until sync bytes
+			if buf[0] != SYNC0 or (len(buf) > 1 and buf[1] != SYNC1):
+				out.write(bytes(buf[:1]))
+				del buf[:1]
+				continue
+
+			# Wait for the whole record
+			if len(buf) < 3 or len(buf) < buf[2] + 4:
+				break
+
+			n = buf[2]
+			payload = bytes(buf[3:3 + n])
+			if (sum(payload) & 0xFF) != buf[3 + n]:
+				# Not a record, resync on the next byte
+				out.write(bytes(buf[:1]))
+				del buf[:1]
+				continue
+			del buf[:n + 4]
+
+			text, cycles = record(elf, payload, cycles, hz)
+			out.write(text)
+
+		out.flush()
+
+
+def open_input(path, baud):
+	if path is None or path == '-':
+		return sys.stdin.buffer
+
+	if stat.S_ISCHR(os.stat(path).st_mode):
+		import termios
+		import tty
+		fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+		tty.setraw(fd)
+		attr = termios.tcgetattr(fd)
+		speed = getattr(termios, 'B%d' % baud)
+		attr[4] = attr[5] = speed
+		termios.tcsetattr(fd, termios.TCSANOW, attr)
+		return os.fdopen(fd, 'rb', buffering=0)
+
+	return open(path, 'rb')
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Decode AE350 binary log records')
+	parser.add_argument('elf', help='ELF file built with LOG_BINARY 1')
+	parser.add_argument('input', nargs='?', help='serial port or capture file, default stdin')
+	parser.add_argument('--baud', type=int, default=38400, help='serial baud rate')
+	parser.add_argument('--hz', type=float, default=0, help='CPU clock to print seconds')
+	opts = parser.parse_args()
+
+	elf = Elf(opts.elf)
+	try:
+		decode(elf, open_input(opts.input, opts.baud), sys.stdout.buffer, opts.hz)
+	except KeyboardInterrupt:
+		pass
+
+
+if __name__ == '__main__':
+	main()